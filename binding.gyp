@@ -13,6 +13,34 @@
       "cflags": [
           "-mrdrnd -mbmi -mavx2 -fpermissive -w",
       ]
+    },
+    {
+      "target_name": "bench",
+      "type": "executable",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [ "./cpp/bench.cc" ],
+      "include_dirs": [
+        "./cpp/mining",
+      ],
+      "cflags": [
+          "-mrdrnd -mbmi -mavx2 -fpermissive -w",
+      ],
+      "libraries": [ "-lpthread" ]
+    },
+    {
+      "target_name": "conformance",
+      "type": "executable",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [ "./cpp/conformance.cc" ],
+      "include_dirs": [
+        "./cpp/mining",
+      ],
+      "cflags": [
+          "-mrdrnd -mbmi -mavx2 -fpermissive -w",
+      ],
+      "libraries": [ "-lpthread" ]
     }
   ]
 }
\ No newline at end of file
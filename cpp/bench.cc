@@ -0,0 +1,236 @@
+// Standalone verification benchmark, runs the scorer without node.
+// Built by node-gyp as build/Release/bench:
+//   bench [solutionsPerAlgo] [threadCounts]
+// e.g. "bench 32 1,2,4,8". By default 16 solutions per algo on 1, 2, 4... up to the hardware threads.
+// The seed and the (publicKey, nonce) sets are fixed, so numbers from two builds are comparable.
+// Every (algo, threads) row runs in a forked child, its peak RSS only covers that run plus the shared random2 pool.
+#include <iostream>
+#include <immintrin.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "keyUtils.hpp"
+#include "memory.hpp"
+#include "public_settings.hpp"
+#include "score.hpp"
+#include "random2_pool.hpp"
+
+using namespace std;
+
+typedef ScoreFunction<
+    NUMBER_OF_SOLUTION_PROCESSORS>
+    ScoreFunctionType;
+
+// m256i is only 8-byte aligned but the scorer's isZero/== use aligned loads
+struct alignas(32) BenchSolution
+{
+    m256i publicKey;
+    m256i nonce;
+};
+
+struct BenchResult
+{
+    double seconds;
+    vector<double> latencies; // milliseconds, one per solution
+    unsigned long long scoreSum;
+};
+
+static double elapsedSeconds(chrono::steady_clock::time_point begin)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+}
+
+// Peak resident set of the process so far in MB, ru_maxrss never decreases so call it from the child of one run
+static double peakRssMB()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+static double percentile(vector<double> values, double p)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    sort(values.begin(), values.end());
+    unsigned long long idx = (unsigned long long)(p * (values.size() - 1) + 0.5);
+    return values[idx];
+}
+
+// Solution i of an algo is derived from (algo, i) only, the nonce parity selects the algo
+static vector<BenchSolution> generateSolutions(score_engine::AlgoType algo, unsigned long long count)
+{
+    vector<BenchSolution> solutions(count);
+    for (unsigned long long i = 0; i < count; i++)
+    {
+        unsigned long long input[2] = {(unsigned long long)algo, i};
+        unsigned char digest[64];
+        KangarooTwelve((const unsigned char *)input, sizeof(input), digest, sizeof(digest));
+        memcpy(solutions[i].publicKey.m256i_u8, digest, 32);
+        memcpy(solutions[i].nonce.m256i_u8, digest + 32, 32);
+        solutions[i].nonce.m256i_u8[0] = (unsigned char)((solutions[i].nonce.m256i_u8[0] & ~1) | (algo == score_engine::AlgoType::Addition ? 1 : 0));
+    }
+    return solutions;
+}
+
+// Score all solutions with numberOfThreads threads pulling from a shared index, like the verify threads do
+static BenchResult runBench(ScoreFunctionType *scoreFunction, const m256i &seed, const unsigned char *pool, const vector<BenchSolution> &solutions, unsigned long long numberOfThreads)
+{
+#if USE_SCORE_CACHE
+    // Every run scores the same solutions, never answer from a previous run
+    ScoreFunctionType::scoreCache.clear();
+#endif
+    BenchResult result;
+    result.latencies.resize(solutions.size());
+    std::atomic<unsigned long long> nextSolution{0};
+    std::atomic<unsigned long long> scoreSum{0};
+
+    auto begin = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (unsigned long long t = 0; t < numberOfThreads; t++)
+    {
+        threads.push_back(thread([&, t]()
+                                 {
+                                     for (unsigned long long i = nextSolution.fetch_add(1); i < solutions.size(); i = nextSolution.fetch_add(1))
+                                     {
+                                         auto solutionBegin = chrono::steady_clock::now();
+                                         unsigned int score = (*scoreFunction)(t, solutions[i].publicKey, seed, solutions[i].nonce, pool);
+                                         result.latencies[i] = elapsedSeconds(solutionBegin) * 1000.0;
+                                         scoreSum.fetch_add(score);
+                                     } }));
+    }
+    for (auto &thread_1 : threads)
+    {
+        thread_1.join();
+    }
+    result.seconds = elapsedSeconds(begin);
+    result.scoreSum = scoreSum;
+    return result;
+}
+
+static vector<unsigned long long> parseThreadCounts(const char *arg)
+{
+    vector<unsigned long long> threadCounts;
+    if (arg)
+    {
+        string list = arg;
+        unsigned long long pos = 0;
+        while (pos < list.size())
+        {
+            unsigned long long comma = list.find(',', pos);
+            if (comma == string::npos)
+            {
+                comma = list.size();
+            }
+            unsigned long long count = strtoull(list.substr(pos, comma - pos).c_str(), NULL, 10);
+            if (count > 0)
+            {
+                threadCounts.push_back(std::min(count, (unsigned long long)NUMBER_OF_SOLUTION_PROCESSORS));
+            }
+            pos = comma + 1;
+        }
+        return threadCounts;
+    }
+
+    unsigned long long maxThreads = std::max(1U, thread::hardware_concurrency());
+    maxThreads = std::min(maxThreads, (unsigned long long)NUMBER_OF_SOLUTION_PROCESSORS);
+    for (unsigned long long count = 1; count < maxThreads; count *= 2)
+    {
+        threadCounts.push_back(count);
+    }
+    threadCounts.push_back(maxThreads);
+    return threadCounts;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long long solutionsPerAlgo = argc > 1 ? strtoull(argv[1], NULL, 10) : 16;
+    if (solutionsPerAlgo == 0)
+    {
+        solutionsPerAlgo = 16;
+    }
+    vector<unsigned long long> threadCounts = parseThreadCounts(argc > 2 ? argv[2] : NULL);
+    if (threadCounts.empty())
+    {
+        printf("usage: %s [solutionsPerAlgo] [threadCounts, e.g. 1,2,4]\n", argv[0]);
+        return 1;
+    }
+
+    alignas(32) m256i seed;
+    for (int i = 0; i < 32; i++)
+    {
+        seed.m256i_u8[i] = (unsigned char)(i * 7 + 1);
+    }
+
+    printf("score kernels: %s\n", score_engine::getScoreIsa());
+
+    Random2PoolCache random2PoolCache;
+    auto poolBegin = chrono::steady_clock::now();
+    std::shared_ptr<const Random2Pool> pool = random2PoolCache.prepare(seed);
+    if (!pool)
+    {
+        printf("failed to allocate random2 pool\n");
+        return 1;
+    }
+    printf("random2 pool build: %.3f s\n", elapsedSeconds(poolBegin));
+
+    // Compute buffers are allocated by the scoring threads as they claim them
+    ScoreFunctionType *scoreFunction = new ScoreFunctionType();
+    scoreFunction->initMemory();
+
+    const score_engine::AlgoType algos[2] = {score_engine::AlgoType::HyperIdentity, score_engine::AlgoType::Addition};
+    const char *algoNames[2] = {"HyperIdentity", "Addition"};
+    vector<BenchSolution> solutions[2];
+    for (int a = 0; a < 2; a++)
+    {
+        solutions[a] = generateSolutions(algos[a], solutionsPerAlgo);
+    }
+
+    printf("%-14s %8s %12s %10s %10s %12s %12s\n", "algo", "threads", "solutions/s", "p50 ms", "p99 ms", "score sum", "peak RSS MB");
+    for (unsigned long long numberOfThreads : threadCounts)
+    {
+        for (int a = 0; a < 2; a++)
+        {
+            // The child inherits the pool and allocates its own compute buffers, the parent never scores.
+            // Flush first or the child would print the parent's buffered output again.
+            fflush(stdout);
+            pid_t child = fork();
+            if (child < 0)
+            {
+                printf("fork failed\n");
+                return 1;
+            }
+            if (child == 0)
+            {
+                BenchResult result = runBench(scoreFunction, seed, pool->data, solutions[a], numberOfThreads);
+                printf("%-14s %8llu %12.3f %10.1f %10.1f %12llu %12.1f\n",
+                       algoNames[a],
+                       numberOfThreads,
+                       solutions[a].size() / result.seconds,
+                       percentile(result.latencies, 0.50),
+                       percentile(result.latencies, 0.99),
+                       result.scoreSum,
+                       peakRssMB());
+                fflush(stdout);
+                _exit(0);
+            }
+            int status = 0;
+            waitpid(child, &status, 0);
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                printf("%-14s %8llu run failed\n", algoNames[a], numberOfThreads);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
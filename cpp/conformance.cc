@@ -0,0 +1,214 @@
+// Conformance runner, checks every scoring path against the golden vectors of cpp/score_vectors.txt.
+// Built by node-gyp as build/Release/conformance:
+//   conformance [vectorFile]  check, exit code 1 on any mismatch
+// The vectors come from the baseline scorer through cpp/tools/score_vectors_gen.cc, never from this tree.
+// Paths checked: single solution (with getLastOutput and the best network digest), score cache hit, early exit at
+// and above the expected score and Addition split across sample threads (with the best network digest). AVX2 builds running on a CPU with AVX-512 popcount check the HyperIdentity
+// vectors with both tick kernels.
+#include <iostream>
+#include <immintrin.h>
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include "keyUtils.hpp"
+#include "memory.hpp"
+#include "public_settings.hpp"
+#include "score.hpp"
+#include "random2_pool.hpp"
+
+using namespace std;
+
+typedef ScoreFunction<1> ScoreFunctionType;
+
+// m256i is only 8-byte aligned but isZero/== use aligned loads, keep every key on a 32 byte boundary
+struct alignas(32) ScoreVector
+{
+    m256i miningSeed;
+    m256i publicKey;
+    m256i nonce;
+    m256i lastOutput;
+    m256i networkDigest;
+    unsigned int score;
+};
+
+static bool hexToM256(const string &hex, m256i &value)
+{
+    if (hex.size() != 64)
+    {
+        return false;
+    }
+    for (int i = 0; i < 32; i++)
+    {
+        char *end = NULL;
+        string byteHex = hex.substr(i * 2, 2);
+        value.m256i_u8[i] = (unsigned char)strtoul(byteHex.c_str(), &end, 16);
+        if (*end != '\0')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static string m256ToHex(const m256i &value)
+{
+    char hex[65];
+    for (int i = 0; i < 32; i++)
+    {
+        snprintf(hex + i * 2, 3, "%02x", value.m256i_u8[i]);
+    }
+    return string(hex, 64);
+}
+
+static bool readVectors(const char *path, vector<ScoreVector> &vectors)
+{
+    ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    string line;
+    while (getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        istringstream fields(line);
+        string seedHex, publicKeyHex, nonceHex, lastOutputHex, networkDigestHex;
+        ScoreVector vector;
+        if (!(fields >> seedHex >> publicKeyHex >> nonceHex >> vector.score >> lastOutputHex >> networkDigestHex) ||
+            !hexToM256(seedHex, vector.miningSeed) || !hexToM256(publicKeyHex, vector.publicKey) ||
+            !hexToM256(nonceHex, vector.nonce) || !hexToM256(lastOutputHex, vector.lastOutput) ||
+            !hexToM256(networkDigestHex, vector.networkDigest))
+        {
+            printf("bad vector line: %s\n", line.c_str());
+            return false;
+        }
+        vectors.push_back(vector);
+    }
+    return true;
+}
+
+static bool isHyperIdentity(const ScoreVector &vector)
+{
+    return score_engine::getAlgoType(vector.nonce.m256i_u8) == score_engine::AlgoType::HyperIdentity;
+}
+
+struct ConformanceRunner
+{
+    ScoreFunctionType *scoreFunction;
+    Random2PoolCache random2PoolCache;
+    unsigned long long failures = 0;
+
+    const unsigned char *getPool(const m256i &miningSeed)
+    {
+        // The cache keeps the current and the previous seed, the corpus is grouped by seed
+        std::shared_ptr<const Random2Pool> pool = random2PoolCache.prepare(miningSeed);
+        return pool ? pool->data : NULL;
+    }
+
+    void check(const char *variant, unsigned long long idx, unsigned int expected, unsigned int score)
+    {
+        if (score != expected)
+        {
+            printf("  FAIL %-14s vector %llu: score %u, expected %u\n", variant, idx, score, expected);
+            failures++;
+        }
+    }
+
+    void checkOutput(const char *variant, unsigned long long idx, const m256i &expected, const m256i &output)
+    {
+        if (memcmp(output.m256i_u8, expected.m256i_u8, 32) != 0)
+        {
+            printf("  FAIL %-14s vector %llu: %s, expected %s\n", variant, idx, m256ToHex(output).c_str(), m256ToHex(expected).c_str());
+            failures++;
+        }
+    }
+
+    // When onlyHyperIdentity is set the Addition vectors are skipped, their kernels do not depend on the ISA switch
+    void runVariants(const vector<ScoreVector> &vectors, bool onlyHyperIdentity)
+    {
+        for (unsigned long long i = 0; i < vectors.size(); i++)
+        {
+            const ScoreVector &vector = vectors[i];
+            if (onlyHyperIdentity && !isHyperIdentity(vector))
+            {
+                continue;
+            }
+            const unsigned char *pool = getPool(vector.miningSeed);
+
+#if USE_SCORE_CACHE
+            ScoreFunctionType::scoreCache.clear();
+#endif
+            m256i lastOutput = m256i::zero();
+            unsigned int score = (*scoreFunction)(0, vector.publicKey, vector.miningSeed, vector.nonce, pool, 0, 1, &lastOutput);
+            check("single", i, vector.score, score);
+            checkOutput("lastOutput", i, vector.lastOutput, lastOutput);
+            checkOutput("networkDigest", i, vector.networkDigest, scoreFunction->_computeBuffer[0]->getBestNetworkDigest());
+#if USE_SCORE_CACHE
+            check("cached", i, vector.score, (*scoreFunction)(0, vector.publicKey, vector.miningSeed, vector.nonce, pool));
+#endif
+
+            // Scores only grow during the search, stopping at the final score must still return it
+            const unsigned long long bufIdx = scoreFunction->acquireComputeBuffer(0);
+            check("earlyExit", i, vector.score, scoreFunction->computeScore(bufIdx, vector.publicKey, vector.nonce, pool, vector.score));
+            // A threshold the solution never reaches must not change its score, nor flag it as a lower bound
+            check("earlyExitUnreached", i, vector.score, scoreFunction->computeScore(bufIdx, vector.publicKey, vector.nonce, pool, vector.score + 1));
+            check("earlyExitUnreachedIsExact", i, 0, scoreFunction->_computeBuffer[bufIdx]->lastScoreIsLowerBound);
+
+            if (!isHyperIdentity(vector))
+            {
+                check("sampleThreads", i, vector.score, scoreFunction->computeScore(bufIdx, vector.publicKey, vector.nonce, pool, 0, 4));
+                checkOutput("sampleThreadsNet", i, vector.networkDigest, scoreFunction->_computeBuffer[bufIdx]->getBestNetworkDigest());
+            }
+            scoreFunction->releaseComputeBuffer(bufIdx);
+        }
+    }
+};
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "cpp/score_vectors.txt";
+
+    vector<ScoreVector> vectors;
+    if (!readVectors(path, vectors))
+    {
+        printf("cannot read score vectors from %s\n", path);
+        return 1;
+    }
+
+    ConformanceRunner runner;
+    runner.scoreFunction = new ScoreFunctionType();
+    runner.scoreFunction->initMemory();
+    // Allocates the only compute buffer, the variants reuse it
+    const unsigned long long bufIdx = runner.scoreFunction->acquireComputeBuffer(0);
+    if (!ScoreFunctionType::isValidComputeBuffer(bufIdx))
+    {
+        printf("failed to allocate score buffers\n");
+        return 1;
+    }
+    runner.scoreFunction->releaseComputeBuffer(bufIdx);
+
+    printf("%llu vectors, score kernels: %s\n", (unsigned long long)vectors.size(), score_engine::getScoreIsa());
+    runner.runVariants(vectors, false);
+#if defined(SCORE_RUNTIME_AVX512_POPCNT)
+    if (score_engine::isAvx512PopcntSupported())
+    {
+        score_engine::useAvx512Popcnt() = false;
+        printf("score kernels: %s\n", score_engine::getScoreIsa());
+        runner.runVariants(vectors, true);
+        score_engine::useAvx512Popcnt() = true;
+    }
+#endif
+
+    if (runner.failures > 0)
+    {
+        printf("%llu mismatches\n", runner.failures);
+        return 1;
+    }
+    printf("all vectors match\n");
+    return 0;
+}
@@ -13,20 +13,93 @@ static void randomNonce(unsigned char *nonce)
     _rdrand64_step((unsigned long long *)&nonce[24]);
 }
 
+// Lowercase hex encoding, writes 2 * sizeInByte chars and a terminator like the former sprintf version,
+// hex must hold 2 * sizeInByte + 1 chars
 static void byteToHex(const uint8_t *byte, char *hex, const int sizeInByte)
 {
-    for (int i = 0; i < sizeInByte; i++)
+    static const char digits[] = "0123456789abcdef";
+    const __m256i lut = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                         '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    int i = 0;
+    for (; i + 16 <= sizeInByte; i += 16)
     {
-        sprintf(hex + i * 2, "%02x", byte[i]);
+        // Widen every byte to 16 bits, then put its high nibble in the low byte and its low nibble in the high byte
+        __m256i x = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(byte + i)));
+        __m256i nibbles = _mm256_or_si256(_mm256_srli_epi16(x, 4), _mm256_slli_epi16(_mm256_and_si256(x, _mm256_set1_epi16(0x0f)), 8));
+        _mm256_storeu_si256((__m256i *)(hex + i * 2), _mm256_shuffle_epi8(lut, nibbles));
+    }
+    for (; i < sizeInByte; i++)
+    {
+        hex[i * 2] = digits[byte[i] >> 4];
+        hex[i * 2 + 1] = digits[byte[i] & 0x0f];
+    }
+    hex[sizeInByte * 2] = '\0';
+}
+
+static inline int hexDigitValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+// Decode 2 * sizeInByte hex chars of either case, return false if any of them is not a hex digit
+static bool hexToByte(const char *hex, uint8_t *byte, const int sizeInByte)
+{
+    int i = 0;
+    for (; i + 16 <= sizeInByte; i += 16)
+    {
+        __m256i c = _mm256_loadu_si256((const __m256i *)(hex + i * 2));
+        __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+        __m256i letter = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+        if (_mm256_movemask_epi8(_mm256_or_si256(isDigit, isLetter)) != -1)
+        {
+            return false;
+        }
+        __m256i value = _mm256_blendv_epi8(_mm256_add_epi8(letter, _mm256_set1_epi8(10)), digit, isDigit);
+
+        // hi * 16 + lo for every pair, then narrow back to bytes and gather both lanes
+        __m256i pairs = _mm256_maddubs_epi16(value, _mm256_set1_epi16(0x0110));
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(pairs, pairs), 0x08);
+        _mm_storeu_si128((__m128i *)(byte + i), _mm256_castsi256_si128(packed));
+    }
+    for (; i < sizeInByte; i++)
+    {
+        int hi = hexDigitValue(hex[i * 2]);
+        int lo = hexDigitValue(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0)
+        {
+            return false;
+        }
+        byte[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+// Batch forms for count fields of sizeInByte bytes laid out back to back, hex must hold 2 * sizeInByte * count + 1 chars
+static void byteToHexBatch(const uint8_t *bytes, char *hex, const int sizeInByte, const int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        byteToHex(bytes + i * sizeInByte, hex + i * sizeInByte * 2, sizeInByte);
     }
 }
 
-static void hexToByte(const char *hex, uint8_t *byte, const int sizeInByte)
+static bool hexToByteBatch(const char *hex, uint8_t *bytes, const int sizeInByte, const int count)
 {
-    for (int i = 0; i < sizeInByte; i++)
+    for (int i = 0; i < count; i++)
     {
-        sscanf(hex + i * 2, "%2hhx", &byte[i]);
+        if (!hexToByte(hex + i * sizeInByte * 2, bytes + i * sizeInByte, sizeInByte))
+        {
+            return false;
+        }
     }
+    return true;
 }
 
 static inline void zero256(__m256i &a)
@@ -2,6 +2,10 @@
 
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 static inline void setMem(void *buffer, unsigned long long size, unsigned char value)
 {
@@ -38,4 +42,88 @@ static inline bool allocPoolWithErrorLog(const wchar_t *name, unsigned long long
 static inline void freePool(void *buffer)
 {
     free(buffer);
-}
\ No newline at end of file
+}
+
+#ifdef __linux__
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+static inline bool isTransparentHugePageEnabled()
+{
+    char mode[64] = {0};
+    FILE *f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    if (!f)
+    {
+        return false;
+    }
+    bool isOk = fgets(mode, sizeof(mode), f) != NULL;
+    fclose(f);
+    return isOk && strstr(mode, "[never]") == NULL;
+}
+#endif
+
+// Allocate size bytes on the largest pages available: 1GB (only when rounding up to whole 1GB pages wastes less than
+// a quarter of them) or 2MB hugetlbfs pages, then transparent huge pages, then regular pages. pageSize receives the
+// page size obtained and must be passed back to freeLargePages. Memory is zero filled.
+static inline bool allocateLargePages(unsigned long long size, void **buffer, unsigned long long *pageSize)
+{
+#ifdef __linux__
+    const unsigned long long hugePageSizes[2] = {1ULL << 30, 2ULL << 20};
+    for (unsigned long long hugePageSize : hugePageSizes)
+    {
+        const int log2PageSize = hugePageSize == (1ULL << 30) ? 30 : 21;
+        const unsigned long long length = (size + hugePageSize - 1) & ~(hugePageSize - 1);
+        // A random2 pool is slightly over 512MB, a whole 1GB page each would pin twice the memory it needs
+        if (hugePageSize == (1ULL << 30) && (length - size) * 4 >= length)
+        {
+            continue;
+        }
+        void *ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log2PageSize << MAP_HUGE_SHIFT), -1, 0);
+        if (ptr != MAP_FAILED)
+        {
+            *buffer = ptr;
+            *pageSize = hugePageSize;
+            return true;
+        }
+    }
+
+    // Transparent huge pages need a 2MB aligned range, so over-allocate and trim both ends
+    const unsigned long long alignment = 2ULL << 20;
+    const unsigned long long length = (size + alignment - 1) & ~(alignment - 1);
+    unsigned char *ptr = (unsigned char *)mmap(NULL, length + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == (unsigned char *)MAP_FAILED)
+    {
+        return false;
+    }
+    unsigned char *aligned = (unsigned char *)(((unsigned long long)ptr + alignment - 1) & ~(alignment - 1));
+    if (aligned != ptr)
+    {
+        munmap(ptr, aligned - ptr);
+    }
+    munmap(aligned + length, ptr + alignment - aligned);
+
+    *buffer = aligned;
+    *pageSize = (madvise(aligned, length, MADV_HUGEPAGE) == 0 && isTransparentHugePageEnabled()) ? alignment : 4096;
+    return true;
+#else
+    *pageSize = 4096;
+    void *ptr = calloc(1, size);
+    if (ptr)
+    {
+        *buffer = ptr;
+        return true;
+    }
+    return false;
+#endif
+}
+
+static inline void freeLargePages(void *buffer, unsigned long long size, unsigned long long pageSize)
+{
+#ifdef __linux__
+    const unsigned long long alignment = pageSize > (2ULL << 20) ? pageSize : (2ULL << 20);
+    munmap(buffer, (size + alignment - 1) & ~(alignment - 1));
+#else
+    free(buffer);
+#endif
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace score_engine
+{
+
+// Helper threads shared by every scorer of the process. They stay parked on a condition variable between
+// ticks and are woken when a scorer hands out work, so splitting a tick does not spawn threads every time.
+struct SampleThreadPool
+{
+private:
+    struct Job
+    {
+        const std::function<void()> *work;
+        unsigned int openSlots;     // helpers that may still join
+        unsigned int activeHelpers; // helpers currently running work
+    };
+
+    std::mutex mutex_;
+    std::condition_variable jobPosted_;
+    std::condition_variable jobDone_;
+    std::deque<Job *> jobs_;
+    std::vector<std::thread> threads_;
+    bool isStopped_ = false;
+
+    void helperLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            jobPosted_.wait(lock, [this]()
+                            { return isStopped_ || !jobs_.empty(); });
+            if (isStopped_)
+            {
+                return;
+            }
+
+            Job *job = jobs_.front();
+            job->activeHelpers++;
+            if (--job->openSlots == 0)
+            {
+                jobs_.pop_front();
+            }
+
+            lock.unlock();
+            (*job->work)();
+            lock.lock();
+
+            if (--job->activeHelpers == 0)
+            {
+                jobDone_.notify_all();
+            }
+        }
+    }
+
+public:
+    static SampleThreadPool &shared()
+    {
+        static SampleThreadPool pool;
+        return pool;
+    }
+
+    ~SampleThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            isStopped_ = true;
+        }
+        jobPosted_.notify_all();
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    // Run work on the calling thread and on up to numberOfHelpers parked threads, return once every helper
+    // that joined is done. work has to split itself between callers (e.g. through a shared chunk counter),
+    // a helper joining late may find nothing left to do. The pool grows to the largest numberOfHelpers asked for.
+    void run(unsigned int numberOfHelpers, const std::function<void()> &work)
+    {
+        if (numberOfHelpers == 0)
+        {
+            work();
+            return;
+        }
+
+        Job job{&work, numberOfHelpers, 0};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (threads_.size() < numberOfHelpers)
+            {
+                threads_.emplace_back([this]()
+                                      { helperLoop(); });
+            }
+            jobs_.push_back(&job);
+        }
+        jobPosted_.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        // The work is done, helpers that did not join yet must not pick up the job anymore
+        if (job.openSlots > 0)
+        {
+            for (auto it = jobs_.begin(); it != jobs_.end(); ++it)
+            {
+                if (*it == &job)
+                {
+                    jobs_.erase(it);
+                    break;
+                }
+            }
+        }
+        jobDone_.wait(lock, [&job]()
+                      { return job.activeHelpers == 0; });
+    }
+};
+
+}
@@ -1,6 +1,10 @@
 ﻿#pragma once
 
 #include "score_common.hpp"
+#include "sample_thread_pool.hpp"
+
+#include <atomic>
+#include <functional>
 
 namespace score_engine
 {
@@ -111,16 +115,33 @@ struct ScoreAddition
     unsigned int incomingNegativeCount[maxNumberOfNeurons];
 
     // Dense incoming-weight matrix indexed as incomingSynapseWeight[target * pop + src].
-    // Values in {-1, 0, +1}. Kept in sync with currentANN.synapsesPacked by mutate();
-    // bestIncomingSynapseWeight is the shadow snapshotted/restored by copyANN.
+    // Values in {-1, 0, +1}. Kept in sync with currentANN.synapsesPacked, together with the
+    // incoming source lists, by setIncomingSynapseWeight().
     alignas(64) char incomingSynapseWeight[maxNumberOfNeurons * maxNumberOfNeurons];
-    alignas(64) char bestIncomingSynapseWeight[maxNumberOfNeurons * maxNumberOfNeurons];
+
+    // Location of the single weight touched by the last mutate(), used by accept/rollback
+    unsigned long long lastMutatedByteIdx;
+    unsigned long long lastMutatedNibblePos;
+    unsigned long long lastMutatedSrcNeuronIdx;
+    unsigned long long lastMutatedTgtNeuronIdx;
 
     // For tracking/compacting sample after each tick
     alignas(64) unsigned int sampleMapping[PADDED_SAMPLES];
     alignas(64) unsigned int sampleScores[PADDED_SAMPLES];
     unsigned long long activeCount;
 
+    // Column range [begin, end) of the compacted samples a kernel works on, both multiples of BATCH_SIZE
+    struct SampleChunk
+    {
+        unsigned long long begin;
+        unsigned long long end;
+    };
+
+    // Threads a tick may split its sample range across, 0 or 1 keeps everything on the calling thread
+    unsigned int numberOfSampleThreads;
+    // Smallest column range worth handing to another thread, below it waking a helper costs more than it saves
+    static constexpr unsigned long long minSamplesPerChunk = 16 * BATCH_SIZE;
+
     // Indices caching look up
     unsigned long long neuronIndices[maxNumberOfNeurons];
     unsigned long long outputNeuronIndices[numberOfOutputNeurons];
@@ -277,14 +298,8 @@ struct ScoreAddition
             outputEvoNeuronIdxCache[numCachedOutputEvo++] = evolutionNeuronIdxCache[i];
     }
 
-    // Bit-flip mutation on the 2-bit packed weight encoding.
-    //   +1 (01) flipped on either bit -> 0 (00 or 11), never -1
-    //   -1 (10) flipped on either bit -> 0 (11 or 00), never +1
-    //   0  (00) -> +1 or -1 depending on which bit is flipped
-    //   0  (11) -> +1 or -1 depending on which bit is flipped (opposite of 00)
-    // Returns true if target neuron is non-input
-    // Returns false if target is an input neuron, so the mutation cannot change R.
-    bool mutate(unsigned long long synapseMutation)
+    // Source neuron and synapse buffer index a mutation picks. Topology is fixed, so the pick only depends on the seed
+    void locateMutation(unsigned long long synapseMutation, unsigned long long &srcNeuronIdx, unsigned long long &synapseIndex) const
     {
         // Seed split: bit 0 -> which of the 2 bits to flip; bits 1..63 -> synapse pick
         unsigned long long population = currentANN.population;
@@ -293,10 +308,32 @@ struct ScoreAddition
         unsigned long long totalValidSynapses = population * actualNeighbors;
         unsigned long long flatIdx = (synapseMutation >> 1) % totalValidSynapses;
 
-        unsigned long long srcNeuronIdx = flatIdx / actualNeighbors;
-        unsigned long long localSynapseIdx = flatIdx % actualNeighbors;
+        srcNeuronIdx = flatIdx / actualNeighbors;
+        synapseIndex = flatIdx % actualNeighbors + getSynapseStartIndex();
+    }
 
-        unsigned long long synapseIndex = localSynapseIdx + getSynapseStartIndex();
+    // Whether mutate(synapseMutation) can change R, i.e. its target is not an input neuron
+    bool isScoringMutation(unsigned long long synapseMutation) const
+    {
+        unsigned long long srcNeuronIdx = 0;
+        unsigned long long synapseIndex = 0;
+        locateMutation(synapseMutation, srcNeuronIdx, synapseIndex);
+        unsigned long long tgtNeuronIdx = clampNeuronIndex((long long)srcNeuronIdx, bufferIndexToOffset(synapseIndex));
+        return currentANN.neuronTypes[tgtNeuronIdx] != INPUT_NEURON_TYPE;
+    }
+
+    // Bit-flip mutation on the 2-bit packed weight encoding.
+    //   +1 (01) flipped on either bit -> 0 (00 or 11), never -1
+    //   -1 (10) flipped on either bit -> 0 (11 or 00), never +1
+    //   0  (00) -> +1 or -1 depending on which bit is flipped
+    //   0  (11) -> +1 or -1 depending on which bit is flipped (opposite of 00)
+    // Returns true if target neuron is non-input
+    // Returns false if target is an input neuron, so the mutation cannot change R.
+    bool mutate(unsigned long long synapseMutation)
+    {
+        unsigned long long srcNeuronIdx = 0;
+        unsigned long long synapseIndex = 0;
+        locateMutation(synapseMutation, srcNeuronIdx, synapseIndex);
         unsigned long long synapseFullBufferIdx = srcNeuronIdx * maxNumberOfNeighbors + synapseIndex;
 
         // which of the 2 bits will be flipped
@@ -314,22 +351,74 @@ struct ScoreAddition
         unsigned long long tgtNeuronIdx = clampNeuronIndex((long long)srcNeuronIdx, offset);
         bool nonInputTarget = currentANN.neuronTypes[tgtNeuronIdx] != INPUT_NEURON_TYPE;
 
-        // Update signed matrix. Decode the new weight after the XOR and
-        // write it directly into incomingSynapseWeight[target][src]. Encoding: 00->0, 01->+1, 10->-1, 11->0.
-        static constexpr char weightFromNibble[4] = {0, +1, -1, 0};
-        unsigned char newNibble =
-            (currentANN.synapsesPacked[byteIdx] >> (nibblePos * 2)) & 0x3u;
-        incomingSynapseWeight[tgtNeuronIdx * maxNumberOfNeurons + srcNeuronIdx] =
-            weightFromNibble[newNibble];
+        // Update signed matrix and source lists. Decode the new weight after the XOR and
+        // write it directly into incomingSynapseWeight[target][src].
+        lastMutatedByteIdx = byteIdx;
+        lastMutatedNibblePos = nibblePos;
+        lastMutatedSrcNeuronIdx = srcNeuronIdx;
+        lastMutatedTgtNeuronIdx = tgtNeuronIdx;
+        setIncomingSynapseWeight(tgtNeuronIdx, srcNeuronIdx, decodeWeight(currentANN.synapsesPacked[byteIdx], nibblePos));
 
         return nonInputTarget;
     }
 
+    // Remove src from one of target's incoming source lists. Order inside a list does not
+    // matter for the K=1 kernels, so the last entry is swapped into the hole.
+    static void removeIncomingSource(unsigned int *sources, unsigned int &count, unsigned long long src)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (sources[i] == (unsigned int)src)
+            {
+                sources[i] = sources[--count];
+                return;
+            }
+        }
+    }
+
+    // Change one incoming weight, keeping incomingSynapseWeight and the sign-split source lists in sync
+    void setIncomingSynapseWeight(unsigned long long tgtNeuronIdx, unsigned long long srcNeuronIdx, char weight)
+    {
+        char &current = incomingSynapseWeight[tgtNeuronIdx * maxNumberOfNeurons + srcNeuronIdx];
+        if (current == weight)
+        {
+            return;
+        }
+
+        unsigned int *positiveSources = &incomingPositiveSource[tgtNeuronIdx * maxNumberOfNeighbors];
+        unsigned int *negativeSources = &incomingNegativeSource[tgtNeuronIdx * maxNumberOfNeighbors];
+        if (current > 0)
+        {
+            removeIncomingSource(positiveSources, incomingPositiveCount[tgtNeuronIdx], srcNeuronIdx);
+        }
+        else if (current < 0)
+        {
+            removeIncomingSource(negativeSources, incomingNegativeCount[tgtNeuronIdx], srcNeuronIdx);
+        }
+
+        if (weight > 0)
+        {
+            positiveSources[incomingPositiveCount[tgtNeuronIdx]++] = (unsigned int)srcNeuronIdx;
+        }
+        else if (weight < 0)
+        {
+            negativeSources[incomingNegativeCount[tgtNeuronIdx]++] = (unsigned int)srcNeuronIdx;
+        }
+        current = weight;
+    }
+
+    // Decode one 2-bit weight of a packed byte. Encoding: 00->0, 01->+1, 10->-1, 11->0.
+    static char decodeWeight(unsigned char packedByte, unsigned long long nibblePos)
+    {
+        static constexpr char weightFromNibble[4] = {0, +1, -1, 0};
+        return weightFromNibble[(packedByte >> (nibblePos * 2)) & 0x3u];
+    }
+
     // Calculate the new neuron index that is reached by moving from the given `neuronIdx` `value`
     // neurons to the right or left. Negative `value` moves to the left, positive `value` moves to
     // the right. The return value is clamped in a ring buffer fashion, i.e. moving right of the
     // rightmost neuron continues at the leftmost neuron.
-    unsigned long long clampNeuronIndex(long long neuronIdx, long long value)
+    unsigned long long clampNeuronIndex(long long neuronIdx, long long value) const
     {
         return clampCirculatingIndex((long long)currentANN.population, neuronIdx, value);
     }
@@ -346,14 +435,14 @@ struct ScoreAddition
         unsigned long long targetNeuronBase,
         const unsigned int *positiveSources, unsigned int numPos,
         const unsigned int *negativeSources, unsigned int numNeg,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const __m512i one16 = _mm512_set1_epi16(1);
         const __m512i negOne16 = _mm512_set1_epi16(-1);
         const __m512i packLoc = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
 
-        unsigned long long s = 0;
-        for (; s + 2 * BATCH_SIZE <= activeSamplePad; s += 2 * BATCH_SIZE)
+        unsigned long long s = chunk.begin;
+        for (; s + 2 * BATCH_SIZE <= chunk.end; s += 2 * BATCH_SIZE)
         {
             __m512i acc16_0a = _mm512_setzero_si512();
             __m512i acc16_1a = _mm512_setzero_si512();
@@ -420,7 +509,7 @@ struct ScoreAddition
                                 _mm512_permutexvar_epi64(packLoc, _mm512_packs_epi16(acc16_0b, acc16_1b)));
         }
 
-        for (; s < activeSamplePad; s += BATCH_SIZE)
+        for (; s < chunk.end; s += BATCH_SIZE)
         {
             __m512i acc16_0 = _mm512_setzero_si512();
             __m512i acc16_1 = _mm512_setzero_si512();
@@ -476,7 +565,7 @@ struct ScoreAddition
         unsigned long long target0NeuronIdx,
         unsigned long long target1NeuronIdx,
         unsigned long long population,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const char *sign0 = &incomingSynapseWeight[target0NeuronIdx * maxNumberOfNeurons];
         const char *sign1 = &incomingSynapseWeight[target1NeuronIdx * maxNumberOfNeurons];
@@ -485,10 +574,10 @@ struct ScoreAddition
         const __m512i negOne16 = _mm512_set1_epi16(-1);
         const __m512i packLoc = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
 
-        unsigned long long s = 0;
+        unsigned long long s = chunk.begin;
 
         // Dual-batch fast path: process two BATCH_SIZE chunks per source load.
-        for (; s + 2 * BATCH_SIZE <= activeSamplePad; s += 2 * BATCH_SIZE)
+        for (; s + 2 * BATCH_SIZE <= chunk.end; s += 2 * BATCH_SIZE)
         {
             __m512i acc0_0a = _mm512_setzero_si512();
             __m512i acc0_1a = _mm512_setzero_si512();
@@ -568,7 +657,7 @@ struct ScoreAddition
         }
 
         // Single-batch tail.
-        for (; s < activeSamplePad; s += BATCH_SIZE)
+        for (; s < chunk.end; s += BATCH_SIZE)
         {
             __m512i acc0_0 = _mm512_setzero_si512();
             __m512i acc0_1 = _mm512_setzero_si512();
@@ -627,7 +716,7 @@ struct ScoreAddition
         const unsigned long long *targetBases,     // length 4
         const unsigned long long *targetNeuronIdx, // length 4 (for incomingSynapseWeight lookup)
         unsigned long long population,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const char *sg0 = &incomingSynapseWeight[targetNeuronIdx[0] * maxNumberOfNeurons];
         const char *sg1 = &incomingSynapseWeight[targetNeuronIdx[1] * maxNumberOfNeurons];
@@ -638,10 +727,10 @@ struct ScoreAddition
         const __m512i negOne16 = _mm512_set1_epi16(-1);
         const __m512i packLoc = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
 
-        unsigned long long s = 0;
+        unsigned long long s = chunk.begin;
 
         // Dual-batch fast path: process two BATCH_SIZE chunks per source load.
-        for (; s + 2 * BATCH_SIZE <= activeSamplePad; s += 2 * BATCH_SIZE)
+        for (; s + 2 * BATCH_SIZE <= chunk.end; s += 2 * BATCH_SIZE)
         {
             __m512i a0_la = _mm512_setzero_si512(), a0_ha = _mm512_setzero_si512();
             __m512i a0_lb = _mm512_setzero_si512(), a0_hb = _mm512_setzero_si512();
@@ -747,8 +836,8 @@ struct ScoreAddition
             #undef STORE_K4_DUAL
         }
 
-        // Single-batch tail for the final BATCH_SIZE chunk (if activeSamplePad % 128 != 0).
-        for (; s < activeSamplePad; s += BATCH_SIZE)
+        // Single-batch tail for the final BATCH_SIZE chunk (if the chunk is not a multiple of 128 samples).
+        for (; s < chunk.end; s += BATCH_SIZE)
         {
             __m512i a_lo0 = _mm512_setzero_si512(), a_hi0 = _mm512_setzero_si512();
             __m512i a_lo1 = _mm512_setzero_si512(), a_hi1 = _mm512_setzero_si512();
@@ -832,7 +921,7 @@ struct ScoreAddition
     void processNeuronTickBlock4Zero_512(
         const unsigned long long *targetBases,
         const unsigned long long *targetNeuronIdx,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const char *sg0 = &incomingSynapseWeight[targetNeuronIdx[0] * maxNumberOfNeurons];
         const char *sg1 = &incomingSynapseWeight[targetNeuronIdx[1] * maxNumberOfNeurons];
@@ -843,10 +932,10 @@ struct ScoreAddition
         const __m512i negOne16 = _mm512_set1_epi16(-1);
         const __m512i packLoc = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
 
-        unsigned long long s = 0;
+        unsigned long long s = chunk.begin;
 
         // Dual-batch fast path
-        for (; s + 2 * BATCH_SIZE <= activeSamplePad; s += 2 * BATCH_SIZE)
+        for (; s + 2 * BATCH_SIZE <= chunk.end; s += 2 * BATCH_SIZE)
         {
             __m512i a0_la = _mm512_setzero_si512(), a0_ha = _mm512_setzero_si512();
             __m512i a0_lb = _mm512_setzero_si512(), a0_hb = _mm512_setzero_si512();
@@ -953,7 +1042,7 @@ struct ScoreAddition
         }
 
         // Single-batch tail
-        for (; s < activeSamplePad; s += BATCH_SIZE)
+        for (; s < chunk.end; s += BATCH_SIZE)
         {
             __m512i a_lo0 = _mm512_setzero_si512(), a_hi0 = _mm512_setzero_si512();
             __m512i a_lo1 = _mm512_setzero_si512(), a_hi1 = _mm512_setzero_si512();
@@ -1038,7 +1127,7 @@ struct ScoreAddition
         unsigned long long target1Base,
         unsigned long long target0NeuronIdx,
         unsigned long long target1NeuronIdx,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const char *sign0 = &incomingSynapseWeight[target0NeuronIdx * maxNumberOfNeurons];
         const char *sign1 = &incomingSynapseWeight[target1NeuronIdx * maxNumberOfNeurons];
@@ -1047,10 +1136,10 @@ struct ScoreAddition
         const __m512i negOne16 = _mm512_set1_epi16(-1);
         const __m512i packLoc = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
 
-        unsigned long long s = 0;
+        unsigned long long s = chunk.begin;
 
         // Dual-batch fast path
-        for (; s + 2 * BATCH_SIZE <= activeSamplePad; s += 2 * BATCH_SIZE)
+        for (; s + 2 * BATCH_SIZE <= chunk.end; s += 2 * BATCH_SIZE)
         {
             __m512i acc0_0a = _mm512_setzero_si512();
             __m512i acc0_1a = _mm512_setzero_si512();
@@ -1129,7 +1218,7 @@ struct ScoreAddition
         }
 
         // Single-batch tail
-        for (; s < activeSamplePad; s += BATCH_SIZE)
+        for (; s < chunk.end; s += BATCH_SIZE)
         {
             __m512i acc0_0 = _mm512_setzero_si512();
             __m512i acc0_1 = _mm512_setzero_si512();
@@ -1186,7 +1275,7 @@ struct ScoreAddition
     void processNeuronTickZero_512(
         unsigned long long targetNeuronBase,
         unsigned long long targetNeuronIdx,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const char *sign = &incomingSynapseWeight[targetNeuronIdx * maxNumberOfNeurons];
 
@@ -1194,10 +1283,10 @@ struct ScoreAddition
         const __m512i negOne16 = _mm512_set1_epi16(-1);
         const __m512i packLoc = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
 
-        unsigned long long s = 0;
+        unsigned long long s = chunk.begin;
 
         // Dual-batch fast path
-        for (; s + 2 * BATCH_SIZE <= activeSamplePad; s += 2 * BATCH_SIZE)
+        for (; s + 2 * BATCH_SIZE <= chunk.end; s += 2 * BATCH_SIZE)
         {
             __m512i acc_0a = _mm512_setzero_si512();
             __m512i acc_1a = _mm512_setzero_si512();
@@ -1245,7 +1334,7 @@ struct ScoreAddition
         }
 
         // Single-batch tail
-        for (; s < activeSamplePad; s += BATCH_SIZE)
+        for (; s < chunk.end; s += BATCH_SIZE)
         {
             __m512i acc_0 = _mm512_setzero_si512();
             __m512i acc_1 = _mm512_setzero_si512();
@@ -1284,13 +1373,13 @@ struct ScoreAddition
         unsigned long long targetNeuronBase,
         const unsigned int *positiveSources, unsigned int numPos,
         const unsigned int *negativeSources, unsigned int numNeg,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const __m256i one16 = _mm256_set1_epi16(1);
         const __m256i negOne16 = _mm256_set1_epi16(-1);
 
-        unsigned long long s = 0;
-        for (; s + 2 * BATCH_SIZE <= activeSamplePad; s += 2 * BATCH_SIZE)
+        unsigned long long s = chunk.begin;
+        for (; s + 2 * BATCH_SIZE <= chunk.end; s += 2 * BATCH_SIZE)
         {
             __m256i acc16_0a = _mm256_setzero_si256();
             __m256i acc16_1a = _mm256_setzero_si256();
@@ -1357,7 +1446,7 @@ struct ScoreAddition
                                 _mm256_permute4x64_epi64(_mm256_packs_epi16(acc16_0b, acc16_1b), 0xD8));
         }
 
-        for (; s < activeSamplePad; s += BATCH_SIZE)
+        for (; s < chunk.end; s += BATCH_SIZE)
         {
             __m256i acc16_0 = _mm256_setzero_si256();
             __m256i acc16_1 = _mm256_setzero_si256();
@@ -1412,7 +1501,7 @@ struct ScoreAddition
         unsigned long long target0NeuronIdx,
         unsigned long long target1NeuronIdx,
         unsigned long long population,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const char *sign0 = &incomingSynapseWeight[target0NeuronIdx * maxNumberOfNeurons];
         const char *sign1 = &incomingSynapseWeight[target1NeuronIdx * maxNumberOfNeurons];
@@ -1420,7 +1509,7 @@ struct ScoreAddition
         const __m256i one16 = _mm256_set1_epi16(1);
         const __m256i negOne16 = _mm256_set1_epi16(-1);
 
-        for (unsigned long long s = 0; s < activeSamplePad; s += BATCH_SIZE)
+        for (unsigned long long s = chunk.begin; s < chunk.end; s += BATCH_SIZE)
         {
             __m256i acc0_0 = _mm256_setzero_si256();
             __m256i acc0_1 = _mm256_setzero_si256();
@@ -1479,7 +1568,7 @@ struct ScoreAddition
         const unsigned long long *targetBases,
         const unsigned long long *targetNeuronIdx,
         unsigned long long population,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const char *sg0 = &incomingSynapseWeight[targetNeuronIdx[0] * maxNumberOfNeurons];
         const char *sg1 = &incomingSynapseWeight[targetNeuronIdx[1] * maxNumberOfNeurons];
@@ -1489,7 +1578,7 @@ struct ScoreAddition
         const __m256i one16 = _mm256_set1_epi16(1);
         const __m256i negOne16 = _mm256_set1_epi16(-1);
 
-        for (unsigned long long s = 0; s < activeSamplePad; s += BATCH_SIZE)
+        for (unsigned long long s = chunk.begin; s < chunk.end; s += BATCH_SIZE)
         {
             __m256i a_lo0 = _mm256_setzero_si256(), a_hi0 = _mm256_setzero_si256();
             __m256i a_lo1 = _mm256_setzero_si256(), a_hi1 = _mm256_setzero_si256();
@@ -1573,7 +1662,7 @@ struct ScoreAddition
     void processNeuronTickBlock4Zero_256(
         const unsigned long long *targetBases,
         const unsigned long long *targetNeuronIdx,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const char *sg0 = &incomingSynapseWeight[targetNeuronIdx[0] * maxNumberOfNeurons];
         const char *sg1 = &incomingSynapseWeight[targetNeuronIdx[1] * maxNumberOfNeurons];
@@ -1583,7 +1672,7 @@ struct ScoreAddition
         const __m256i one16 = _mm256_set1_epi16(1);
         const __m256i negOne16 = _mm256_set1_epi16(-1);
 
-        for (unsigned long long s = 0; s < activeSamplePad; s += BATCH_SIZE)
+        for (unsigned long long s = chunk.begin; s < chunk.end; s += BATCH_SIZE)
         {
             __m256i a_lo0 = _mm256_setzero_si256(), a_hi0 = _mm256_setzero_si256();
             __m256i a_lo1 = _mm256_setzero_si256(), a_hi1 = _mm256_setzero_si256();
@@ -1668,7 +1757,7 @@ struct ScoreAddition
         unsigned long long target1Base,
         unsigned long long target0NeuronIdx,
         unsigned long long target1NeuronIdx,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const char *sign0 = &incomingSynapseWeight[target0NeuronIdx * maxNumberOfNeurons];
         const char *sign1 = &incomingSynapseWeight[target1NeuronIdx * maxNumberOfNeurons];
@@ -1676,7 +1765,7 @@ struct ScoreAddition
         const __m256i one16 = _mm256_set1_epi16(1);
         const __m256i negOne16 = _mm256_set1_epi16(-1);
 
-        for (unsigned long long s = 0; s < activeSamplePad; s += BATCH_SIZE)
+        for (unsigned long long s = chunk.begin; s < chunk.end; s += BATCH_SIZE)
         {
             __m256i acc0_0 = _mm256_setzero_si256();
             __m256i acc0_1 = _mm256_setzero_si256();
@@ -1733,14 +1822,14 @@ struct ScoreAddition
     void processNeuronTickZero_256(
         unsigned long long targetNeuronBase,
         unsigned long long targetNeuronIdx,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const char *sign = &incomingSynapseWeight[targetNeuronIdx * maxNumberOfNeurons];
 
         const __m256i one16 = _mm256_set1_epi16(1);
         const __m256i negOne16 = _mm256_set1_epi16(-1);
 
-        for (unsigned long long s = 0; s < activeSamplePad; s += BATCH_SIZE)
+        for (unsigned long long s = chunk.begin; s < chunk.end; s += BATCH_SIZE)
         {
             __m256i acc_0 = _mm256_setzero_si256();
             __m256i acc_1 = _mm256_setzero_si256();
@@ -1776,7 +1865,7 @@ struct ScoreAddition
 
 #endif
 
-    void processNeuronTick(unsigned long long targetNeuron, unsigned long long activeSamplePad)
+    void processNeuronTick(unsigned long long targetNeuron, const SampleChunk &chunk)
     {
         const unsigned long long offset = targetNeuron * maxNumberOfNeighbors;
         const unsigned long long base = targetNeuron * PADDED_SAMPLES;
@@ -1784,12 +1873,12 @@ struct ScoreAddition
         processNeuronTick512(base,
                                 &incomingPositiveSource[offset], incomingPositiveCount[targetNeuron],
                                 &incomingNegativeSource[offset], incomingNegativeCount[targetNeuron],
-                                activeSamplePad);
+                                chunk);
 #else
         processNeuronTick256(base,
                                 &incomingPositiveSource[offset], incomingPositiveCount[targetNeuron],
                                 &incomingNegativeSource[offset], incomingNegativeCount[targetNeuron],
-                                activeSamplePad);
+                                chunk);
 #endif
     }
 
@@ -1798,16 +1887,16 @@ struct ScoreAddition
         unsigned long long target0NeuronIdx,
         unsigned long long target1NeuronIdx,
         unsigned long long population,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const unsigned long long base0 = target0NeuronIdx * PADDED_SAMPLES;
         const unsigned long long base1 = target1NeuronIdx * PADDED_SAMPLES;
 #if defined(__AVX512F__)
         processNeuronTickBlock2_512(base0, base1, target0NeuronIdx, target1NeuronIdx,
-                                    population, activeSamplePad);
+                                    population, chunk);
 #else
         processNeuronTickBlock2_256(base0, base1, target0NeuronIdx, target1NeuronIdx,
-                                    population, activeSamplePad);
+                                    population, chunk);
 #endif
     }
 
@@ -1815,15 +1904,15 @@ struct ScoreAddition
     void processNeuronTickBlock4(
         const unsigned long long *targetNeuronIdx, // length 4
         unsigned long long population,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         unsigned long long bases[4];
         for (int k = 0; k < 4; k++)
             bases[k] = targetNeuronIdx[k] * PADDED_SAMPLES;
 #if defined(__AVX512F__)
-        processNeuronTickBlock4_512(bases, targetNeuronIdx, population, activeSamplePad);
+        processNeuronTickBlock4_512(bases, targetNeuronIdx, population, chunk);
 #else
-        processNeuronTickBlock4_256(bases, targetNeuronIdx, population, activeSamplePad);
+        processNeuronTickBlock4_256(bases, targetNeuronIdx, population, chunk);
 #endif
     }
 
@@ -1831,13 +1920,12 @@ struct ScoreAddition
     // K-block dispatch: K=4 primary, K=2 tail, K=1 last. Identical math to a single-pass
     // processTick — the split into two subset calls (outputs first, evolutions after the
     // exit check) lives in runTickSimulation.
-    void processTickSubset(unsigned long long startIdx, unsigned long long endIdx)
+    void processTickSubset(const SampleChunk &chunk, unsigned long long startIdx, unsigned long long endIdx)
     {
-        unsigned long long activeSamplePad = ((activeCount + BATCH_SIZE - 1) / BATCH_SIZE) * BATCH_SIZE;
         const unsigned long long population = currentANN.population;
 
         {
-            // PROFILE_NAMED_SCOPE("processTick:EvolutionLoop");
+            PROFILE_NAMED_SCOPE("processTick:EvolutionLoop");
             unsigned long long idx = startIdx;
 
             // Primary path: K=4 blocks.
@@ -1845,7 +1933,7 @@ struct ScoreAddition
             {
                 processNeuronTickBlock4(
                     &outputEvoNeuronIdxCache[idx],
-                    population, activeSamplePad);
+                    population, chunk);
             }
 
             // Tail: K=2 block for remainder of size 2-3.
@@ -1854,13 +1942,13 @@ struct ScoreAddition
                 processNeuronTickBlock2(
                     outputEvoNeuronIdxCache[idx],
                     outputEvoNeuronIdxCache[idx + 1],
-                    population, activeSamplePad);
+                    population, chunk);
             }
 
             // Final odd target: K=1 tail.
             for (; idx < endIdx; ++idx)
             {
-                processNeuronTick(outputEvoNeuronIdxCache[idx], activeSamplePad);
+                processNeuronTick(outputEvoNeuronIdxCache[idx], chunk);
             }
         }
     }
@@ -1868,7 +1956,7 @@ struct ScoreAddition
     // K=4 tick-zero dispatcher
     void processNeuronTickBlock4Zero(
         const unsigned long long *targetNeuronIdx, // length 4
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         unsigned long long bases[4];
         for (int k = 0; k < 4; k++)
@@ -1876,9 +1964,9 @@ struct ScoreAddition
             bases[k] = targetNeuronIdx[k] * PADDED_SAMPLES;
         }
 #if defined(__AVX512F__)
-        processNeuronTickBlock4Zero_512(bases, targetNeuronIdx, activeSamplePad);
+        processNeuronTickBlock4Zero_512(bases, targetNeuronIdx, chunk);
 #else
-        processNeuronTickBlock4Zero_256(bases, targetNeuronIdx, activeSamplePad);
+        processNeuronTickBlock4Zero_256(bases, targetNeuronIdx, chunk);
 #endif
     }
 
@@ -1886,40 +1974,37 @@ struct ScoreAddition
     void processNeuronTickBlock2Zero(
         unsigned long long target0NeuronIdx,
         unsigned long long target1NeuronIdx,
-        unsigned long long activeSamplePad)
+        const SampleChunk &chunk)
     {
         const unsigned long long base0 = target0NeuronIdx * PADDED_SAMPLES;
         const unsigned long long base1 = target1NeuronIdx * PADDED_SAMPLES;
 #if defined(__AVX512F__)
         processNeuronTickBlock2Zero_512(base0, base1, target0NeuronIdx, target1NeuronIdx,
-                                        activeSamplePad);
+                                        chunk);
 #else
         processNeuronTickBlock2Zero_256(base0, base1, target0NeuronIdx, target1NeuronIdx,
-                                        activeSamplePad);
+                                        chunk);
 #endif
     }
 
     // K = 1 tick-zero dispatcher.
     void processNeuronTickZero(unsigned long long targetNeuronIdx,
-                                unsigned long long activeSamplePad)
+                                const SampleChunk &chunk)
     {
         const unsigned long long base = targetNeuronIdx * PADDED_SAMPLES;
 #if defined(__AVX512F__)
-        processNeuronTickZero_512(base, targetNeuronIdx, activeSamplePad);
+        processNeuronTickZero_512(base, targetNeuronIdx, chunk);
 #else
-        processNeuronTickZero_256(base, targetNeuronIdx, activeSamplePad);
+        processNeuronTickZero_256(base, targetNeuronIdx, chunk);
 #endif
     }
 
     // At tick 0, prev[output/evolution] = 0, so the accumulator for
     // every target depends ONLY on input sources
-    void processTickZeroSubset(unsigned long long startIdx, unsigned long long endIdx)
+    void processTickZeroSubset(const SampleChunk &chunk, unsigned long long startIdx, unsigned long long endIdx)
     {
-        unsigned long long activeSamplePad = ((activeCount + BATCH_SIZE - 1) / BATCH_SIZE) * BATCH_SIZE;
-        const unsigned long long population = currentANN.population;
-
         {
-            // PROFILE_NAMED_SCOPE("processTick:EvolutionLoop");
+            PROFILE_NAMED_SCOPE("processTickZero:EvolutionLoop");
             unsigned long long idx = startIdx;
 
             // K=4 blocks with tick-zero kernel (input sources only).
@@ -1927,7 +2012,7 @@ struct ScoreAddition
             {
                 processNeuronTickBlock4Zero(
                     &outputEvoNeuronIdxCache[idx],
-                    activeSamplePad);
+                    chunk);
             }
 
             // K = 2 tail
@@ -1936,13 +2021,13 @@ struct ScoreAddition
                 processNeuronTickBlock2Zero(
                     outputEvoNeuronIdxCache[idx],
                     outputEvoNeuronIdxCache[idx + 1],
-                    activeSamplePad);
+                    chunk);
             }
 
             // K = 1 tail
             for (; idx < endIdx; ++idx)
             {
-                processNeuronTickZero(outputEvoNeuronIdxCache[idx], activeSamplePad);
+                processNeuronTickZero(outputEvoNeuronIdxCache[idx], chunk);
             }
         }
     }
@@ -2506,15 +2591,69 @@ struct ScoreAddition
         return (activeCount == 0);
     }
 
+    void processTickChunk(const SampleChunk &chunk, bool isTickZero, unsigned long long startIdx, unsigned long long endIdx)
+    {
+        if (isTickZero)
+        {
+            processTickZeroSubset(chunk, startIdx, endIdx);
+        }
+        else
+        {
+            processTickSubset(chunk, startIdx, endIdx);
+        }
+    }
+
+    // Run one tick of targets [startIdx, endIdx) over all active samples. Every target of a tick only reads
+    // prevNeuronValues, so the sample columns are independent and can be split across threads. Samples stay
+    // compacted globally (compaction is cheap and serial), each thread pulls the next column chunk from a
+    // shared counter so uneven chunks balance out. The helpers come from the process wide SampleThreadPool.
+    void processTick(bool isTickZero, unsigned long long startIdx, unsigned long long endIdx)
+    {
+        const unsigned long long activeSamplePad = ((activeCount + BATCH_SIZE - 1) / BATCH_SIZE) * BATCH_SIZE;
+        unsigned long long numberOfThreads = numberOfSampleThreads;
+        if (numberOfThreads > activeSamplePad / minSamplesPerChunk)
+        {
+            numberOfThreads = activeSamplePad / minSamplesPerChunk;
+        }
+        if (numberOfThreads <= 1)
+        {
+            processTickChunk({0, activeSamplePad}, isTickZero, startIdx, endIdx);
+            return;
+        }
+
+        // A few chunks per thread so a slow thread does not hold up the tick
+        unsigned long long numberOfChunks = numberOfThreads * 2;
+        if (numberOfChunks > activeSamplePad / minSamplesPerChunk)
+        {
+            numberOfChunks = activeSamplePad / minSamplesPerChunk;
+        }
+        const unsigned long long chunkSize = (activeSamplePad / BATCH_SIZE + numberOfChunks - 1) / numberOfChunks * BATCH_SIZE;
+
+        std::atomic<unsigned long long> nextChunk{0};
+        const std::function<void()> worker = [&]()
+        {
+            for (unsigned long long c = nextChunk.fetch_add(1); c < numberOfChunks; c = nextChunk.fetch_add(1))
+            {
+                const unsigned long long begin = c * chunkSize;
+                if (begin >= activeSamplePad)
+                {
+                    break;
+                }
+                const unsigned long long end = (begin + chunkSize < activeSamplePad) ? begin + chunkSize : activeSamplePad;
+                processTickChunk({begin, end}, isTickZero, startIdx, endIdx);
+            }
+        };
+
+        SampleThreadPool::shared().run((unsigned int)(numberOfThreads - 1), worker);
+    }
+
     // Tick simulation only runs on one ANN
     void runTickSimulation()
     {
-        // PROFILE_NAMED_SCOPE("runTickSimulation");
+        PROFILE_NAMED_SCOPE("runTickSimulation");
 
-        unsigned long long population = currentANN.population;
-        unsigned char *neuronTypes = currentANN.neuronTypes;
         {
-            // PROFILE_NAMED_SCOPE("runTickSimulation:PrepareData");
+            PROFILE_NAMED_SCOPE("runTickSimulation:PrepareData");
             for (unsigned long long i = 0; i < trainingSetSize; i++)
             {
                 sampleMapping[i] = (unsigned int)i;
@@ -2522,19 +2661,12 @@ struct ScoreAddition
             }
             activeCount = trainingSetSize;
 
+            // Incoming source lists for the K=1 kernels are kept up to date by mutate()
             loadTrainingData();
-
-            const bool k1KernelMayRun =
-                (numCachedOutputs & 1ULL) || (numCachedEvolution & 1ULL);
-            if (k1KernelMayRun)
-            {
-                decodeSynapses();
-                convertToIncomingSynapses();
-            }
         }
 
         {
-            // PROFILE_NAMED_SCOPE("runTickSimulation:Ticking");
+            PROFILE_NAMED_SCOPE("runTickSimulation:Ticking");
             for (unsigned long long tick = 0; tick < numberOfTicks; ++tick)
             {
                 // No more ANN to infer aka stop condition of all samples are hit
@@ -2547,20 +2679,13 @@ struct ScoreAddition
 
                 // Process output first
                 {
-                    // PROFILE_NAMED_SCOPE("Ticking:processTick");
-                    if (tick == 0)
-                    {
-                        processTickZeroSubset(0, numCachedOutputs);
-                    }
-                    else
-                    {
-                        processTickSubset(0, numCachedOutputs);
-                    }
+                    PROFILE_NAMED_SCOPE("Ticking:processTickOutput");
+                    processTick(tick == 0, 0, numCachedOutputs);
                 }
 
                 // Compact ouput
                 {
-                    // PROFILE_NAMED_SCOPE("Ticking:compactActiveSamplesWithScoring");
+                    PROFILE_NAMED_SCOPE("Ticking:compactActiveSamplesWithScoring");
                     if (compactActiveSamplesWithScoringSIMD(true, (tick == 0)))
                     {
                         break;
@@ -2573,15 +2698,8 @@ struct ScoreAddition
                     break;
                 }
                 {
-                    // PROFILE_NAMED_SCOPE("Ticking:processTick");
-                    if (tick == 0)
-                    {
-                        processTickZeroSubset(numCachedOutputs, numCachedOutputEvo);
-                    }
-                    else
-                    {
-                        processTickSubset(numCachedOutputs, numCachedOutputEvo);
-                    }
+                    PROFILE_NAMED_SCOPE("Ticking:processTickEvolution");
+                    processTick(tick == 0, numCachedOutputs, numCachedOutputEvo);
                 }
             }
         }
@@ -2716,10 +2834,9 @@ struct ScoreAddition
         // and population are set once and never change.
         cacheOutputEvoNeuronIndices();
 
-        // Build the incoming-weight matrix and snapshot it as bestIncomingSynapseWeight.
+        // Build the incoming-weight matrix
         decodeSynapses();
         convertToIncomingSynapses();
-        copyMem(bestIncomingSynapseWeight, incomingSynapseWeight, sizeof(incomingSynapseWeight));
 
         // Run the first inference to get starting point before mutation
         unsigned int score = inferANN();
@@ -2732,32 +2849,51 @@ struct ScoreAddition
         copyMem(dst.neuronTypes, src.neuronTypes, maxNumberOfNeurons);
         copyMem(dst.synapsesPacked, src.synapsesPacked, sizeof(src.synapsesPacked));
         dst.population = src.population;
+    }
 
-        // Keep incomingSynapseWeight and bestIncomingSynapseWeight in sync with the synapses they shadow.
-        //   copyANN(bestANN, currentANN)  -> "accept": snapshot incomingSynapseWeight into bestIncomingSynapseWeight.
-        //   copyANN(currentANN, bestANN)  -> "rollback": restore incomingSynapseWeight from bestIncomingSynapseWeight.
-        if (&dst == &bestANN)
-        {
-            copyMem(bestIncomingSynapseWeight, incomingSynapseWeight, sizeof(incomingSynapseWeight));
-        }
-        else if (&dst == &currentANN)
-        {
-            copyMem(incomingSynapseWeight, bestIncomingSynapseWeight, sizeof(incomingSynapseWeight));
-        }
+    // Topology is fixed and mutate() flips exactly one 2-bit weight, so accepting or
+    // rolling back only has to move that packed byte and its incoming weight.
+    void acceptMutation()
+    {
+        bestANN.synapsesPacked[lastMutatedByteIdx] = currentANN.synapsesPacked[lastMutatedByteIdx];
+    }
+
+    void rollbackMutation()
+    {
+        unsigned char packedByte = bestANN.synapsesPacked[lastMutatedByteIdx];
+        currentANN.synapsesPacked[lastMutatedByteIdx] = packedByte;
+        setIncomingSynapseWeight(lastMutatedTgtNeuronIdx, lastMutatedSrcNeuronIdx, decodeWeight(packedByte, lastMutatedNibblePos));
     }
 
     // Main function for mining
-    unsigned int computeScore(const unsigned char *publicKey, const unsigned char *nonce, const unsigned char *randomPool)
+    // With a non-zero scoreThreshold the search stops as soon as bestR reaches it, the result is then only
+    // a lower bound of the exact score (bestR never decreases). It also stops once no remaining mutation can
+    // change R, a score still below scoreThreshold then is exact.
+    unsigned int computeScore(const unsigned char *publicKey, const unsigned char *nonce, const unsigned char *randomPool, unsigned int scoreThreshold = 0)
     {
-        // PROFILE_NAMED_SCOPE("computeScore");
+        PROFILE_NAMED_SCOPE("computeScore");
 
         // Initialize
         unsigned int bestR = initializeANN(publicKey, nonce, randomPool);
         copyANN(bestANN, currentANN);
 
         InitValue *initValue = (InitValue *)paddingInitValue;
-        for (unsigned long long s = 0; s < numberOfMutations; ++s)
+        unsigned long long numberOfSearchedMutations = numberOfMutations;
+        if (scoreThreshold)
         {
+            // Mutations into an input neuron cannot change R, after the last other one bestR is final
+            while (numberOfSearchedMutations > 0 && !isScoringMutation(initValue->synapseMutation[numberOfSearchedMutations - 1]))
+            {
+                numberOfSearchedMutations--;
+            }
+        }
+        for (unsigned long long s = 0; s < numberOfSearchedMutations; ++s)
+        {
+            if (scoreThreshold && bestR >= scoreThreshold)
+            {
+                break;
+            }
+
             if (mutate(initValue->synapseMutation[s]))
             {
                 // Ticks simulation
@@ -2768,23 +2904,30 @@ struct ScoreAddition
                 {
                     bestR = R;
                     // Better R. Save the state
-                    copyANN(bestANN, currentANN);
+                    acceptMutation();
                 }
                 else
                 {
                     // Roll back
-                    copyANN(currentANN, bestANN);
+                    rollbackMutation();
                 }
             }
             else
             {
                 // Input-target mutation so R is unchanged from the previous iteration.
                 // copy the new currentANN into bestANN.
-                copyANN(bestANN, currentANN);
+                acceptMutation();
             }
         }
         return bestR;
     }
+
+    // 32-byte digest of the synapses of the best network the last computeScore kept. Two runs that accepted
+    // different mutations give different digests, cpp/tools/score_vectors_gen.cc computes the same one.
+    void getBestNetworkDigest(unsigned char *digest)
+    {
+        KangarooTwelve(bestANN.synapsesPacked, sizeof(bestANN.synapsesPacked), digest, 32);
+    }
 };
 
 }
@@ -136,15 +136,57 @@ namespace score_engine
 #elif defined(__AVX2__)
     static constexpr int BATCH_SIZE = 32;
     static constexpr int BATCH_SIZE_X8 = BATCH_SIZE * 8;
-    static inline unsigned popcnt256(__m256i v)
+    // Popcount of every byte with a nibble lookup, nothing leaves the vector registers. A byte count is at most 8,
+    // so up to 31 results can be summed with _mm256_add_epi8 before widening them with _mm256_sad_epu8.
+    static inline __m256i popcnt256Epi8(__m256i v)
     {
-        return popcnt64(_mm256_extract_epi64(v, 0)) +
-               popcnt64(_mm256_extract_epi64(v, 1)) +
-               popcnt64(_mm256_extract_epi64(v, 2)) +
-               popcnt64(_mm256_extract_epi64(v, 3));
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+        const __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, lowNibble));
+        const __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble));
+        return _mm256_add_epi8(lo, hi);
     }
 
+    static inline long long reduceAdd256Epi64(__m256i v)
+    {
+        const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        return _mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1);
+    }
+
+#endif
+
+// An AVX2 build can still run the HyperIdentity tick with AVX-512 popcount, the CPU is checked once at runtime
+#if !defined(__AVX512F__) && defined(__GNUC__)
+#define SCORE_RUNTIME_AVX512_POPCNT 1
+#define SCORE_TARGET_AVX512_POPCNT __attribute__((target("avx512f,avx512bw,avx512vl,avx512vpopcntdq")))
+    static inline bool isAvx512PopcntSupported()
+    {
+        static const bool isSupported = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                                        __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512vpopcntdq");
+        return isSupported;
+    }
+
+    // Kernel the HyperIdentity tick uses, defaults to the best one the CPU supports. Clearing it forces the AVX2
+    // kernel, the conformance runner uses that to check both kernels on one machine.
+    static inline bool &useAvx512Popcnt()
+    {
+        static bool isEnabled = isAvx512PopcntSupported();
+        return isEnabled;
+    }
+#endif
+
+    // Instruction set the scorer kernels run with on this machine
+    static inline const char *getScoreIsa()
+    {
+#if defined(__AVX512F__)
+        return "avx512";
+#elif defined(SCORE_RUNTIME_AVX512_POPCNT)
+        return useAvx512Popcnt() ? "avx2+avx512-vpopcntdq" : "avx2";
+#else
+        return "avx2";
 #endif
+    }
 
     static void generateRandom2Pool(const unsigned char *miningSeed, unsigned char *state, unsigned char *pool)
     {
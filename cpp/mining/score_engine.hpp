@@ -12,6 +12,8 @@ namespace score_engine
         ScoreHyperIdentity<HyperIdentityParamsT> _hyperIdentityScore;
         ScoreAddition<AdditionParamsT> _additionScore;
         unsigned char lastNonceByte0;
+        // The last computeScore stopped at its scoreThreshold, its score is only a lower bound of the exact one
+        bool lastScoreIsLowerBound;
 
         void initMemory()
         {
@@ -22,32 +24,51 @@ namespace score_engine
             _additionScore.initMemory();
         }
 
+        // Threads the next scores may split their training samples across, only the Addition algo uses it
+        void setNumberOfSampleThreads(unsigned int numberOfThreads)
+        {
+            _additionScore.numberOfSampleThreads = numberOfThreads;
+        }
+
         // Unused function
         void initMiningData(const unsigned char *randomPool)
         {
         }
 
-        unsigned int computeHyperIdentityScore(const unsigned char *publicKey, const unsigned char *nonce, const unsigned char *randomPool)
+        unsigned int computeHyperIdentityScore(const unsigned char *publicKey, const unsigned char *nonce, const unsigned char *randomPool, unsigned int scoreThreshold = 0)
         {
-            return _hyperIdentityScore.computeScore(publicKey, nonce, randomPool);
+            return _hyperIdentityScore.computeScore(publicKey, nonce, randomPool, scoreThreshold);
         }
 
-        unsigned int computeAdditionScore(const unsigned char *publicKey, const unsigned char *nonce, const unsigned char *randomPool)
+        unsigned int computeAdditionScore(const unsigned char *publicKey, const unsigned char *nonce, const unsigned char *randomPool, unsigned int scoreThreshold = 0)
         {
-            return _additionScore.computeScore(publicKey, nonce, randomPool);
+            return _additionScore.computeScore(publicKey, nonce, randomPool, scoreThreshold);
         }
 
-        unsigned int computeScore(const unsigned char *publicKey, const unsigned char *nonce, const unsigned char *randomPool)
+        // scoreThreshold = 0 computes the exact score. Otherwise the search may stop once the score reaches
+        // scoreThreshold and return that lower bound, a threshold out of range for the algo is ignored.
+        unsigned int computeScore(const unsigned char *publicKey, const unsigned char *nonce, const unsigned char *randomPool, unsigned int scoreThreshold = 0)
         {
             lastNonceByte0 = nonce[0];
+            unsigned int score = 0;
             if ((nonce[0] & 1) == 0)
             {
-                return computeHyperIdentityScore(publicKey, nonce, randomPool);
+                if (!checkAlgoThreshold(scoreThreshold, AlgoType::HyperIdentity))
+                {
+                    scoreThreshold = 0;
+                }
+                score = computeHyperIdentityScore(publicKey, nonce, randomPool, scoreThreshold);
             }
             else
             {
-                return computeAdditionScore(publicKey, nonce, randomPool);
+                if (!checkAlgoThreshold(scoreThreshold, AlgoType::Addition))
+                {
+                    scoreThreshold = 0;
+                }
+                score = computeAdditionScore(publicKey, nonce, randomPool, scoreThreshold);
             }
+            lastScoreIsLowerBound = scoreThreshold && score >= scoreThreshold;
+            return score;
         }
 
         // returns last computed output neurons, only returns 256 non-zero neurons, neuron values are compressed to bit
@@ -62,6 +83,21 @@ namespace score_engine
             }
             return result;
         }
+
+        // Digest of the best network the last computeScore kept, for comparing scorer implementations
+        m256i getBestNetworkDigest()
+        {
+            m256i result;
+            if ((lastNonceByte0 & 1) == 0)
+            {
+                _hyperIdentityScore.getBestNetworkDigest(result.m256i_u8);
+            }
+            else
+            {
+                _additionScore.getBestNetworkDigest(result.m256i_u8);
+            }
+            return result;
+        }
     };
 
 }
\ No newline at end of file
@@ -71,14 +71,21 @@ namespace score_engine
                 neurons = paddingNeurons + radius;
             }
 
-            void copyDataTo(ANN &rOther)
+            // Copy everything but the synapses, enough when only neuron values and single synapses differ
+            void copyNeuronsTo(ANN &rOther)
             {
                 copyMem(rOther.neurons, neurons, population * sizeof(Neuron));
                 copyMem(rOther.neuronTypes, neuronTypes, population * sizeof(NeuronType));
-                copyMem(rOther.synapses, synapses, maxNumberOfSynapses * sizeof(Synapse));
                 rOther.population = population;
             }
 
+            void copyDataTo(ANN &rOther)
+            {
+                copyNeuronsTo(rOther);
+                // Synapses of neurons past the population are never read
+                copyMem(rOther.synapses, synapses, population * numberOfNeighbors * sizeof(Synapse));
+            }
+
             Neuron *neurons;
             // Padding start and end of neurons so that we can reduce the condition checking
             Neuron paddingNeurons[(maxNumberOfNeurons + numberOfNeighbors + BATCH_SIZE - 1) / BATCH_SIZE * BATCH_SIZE];
@@ -105,11 +112,8 @@ namespace score_engine
         MiningData miningData;
 
         unsigned long long neuronIndices[numberOfNeurons];
-        Neuron previousNeuronValue[maxNumberOfNeurons];
-
         Neuron outputNeuronExpectedValue[numberOfOutputNeurons];
 
-        Neuron neuronValueBuffer[maxNumberOfNeurons];
         unsigned char hash[32];
         unsigned char combined[64];
 
@@ -121,13 +125,22 @@ namespace score_engine
         // Padding to fix bytes for each row
         Synapse paddingIncommingSynapses[populationThreshold * incommingSynapsesPitch];
 
-        unsigned char nextNeuronPlus1s[(maxNumberOfNeurons + numberOfNeighbors + BATCH_SIZE - 1) / BATCH_SIZE * BATCH_SIZE];
-        unsigned char nextNeuronMinus1s[(maxNumberOfNeurons + numberOfNeighbors + BATCH_SIZE - 1) / BATCH_SIZE * BATCH_SIZE];
+        // Neuron bitmaps read and written by processTick. They point into currentANN and swap after every tick
+        unsigned char *neuronPlus1s;
+        unsigned char *neuronMinus1s;
+        unsigned char *nextNeuronPlus1s;
+        unsigned char *nextNeuronMinus1s;
 
         unsigned char keptNeurons[maxNumberOfNeurons];
         unsigned long long affectedNeurons[maxNumberOfNeurons];
         unsigned long long nextAffectedNeurons[maxNumberOfNeurons];
 
+        // paddingIncommingSynapses and the synapse masks of currentANN follow currentANN.synapses across mutations.
+        // A weight change patches one entry, a structural change (neuron inserted or removed) forces a rebuild.
+        bool isIncommingSynapsesValid;
+        // Synapse changed by the last mutation, -1 if the last mutation changed the structure
+        long long lastMutatedSynapseIdx;
+
         void mutate(unsigned long long mutateStep)
         {
             // Mutation
@@ -156,14 +169,28 @@ namespace score_engine
             if (newWeight >= -1 && newWeight <= 1)
             {
                 synapses[synapseIdx] = newWeight;
+                lastMutatedSynapseIdx = (long long)synapseIdx;
             }
             else // Invalid weight. Insert a neuron
             {
                 // Insert the neuron
                 insertNeuron(synapseIdx);
+                lastMutatedSynapseIdx = -1;
             }
             // Clean the ANN
-            cleanANN();
+            if (cleanANN())
+            {
+                lastMutatedSynapseIdx = -1;
+            }
+
+            if (lastMutatedSynapseIdx >= 0)
+            {
+                updateIncommingSynapse(lastMutatedSynapseIdx);
+            }
+            else
+            {
+                isIncommingSynapsesValid = false;
+            }
         }
 
         // Get the pointer to all outgoing synapse of a neurons
@@ -206,9 +233,9 @@ namespace score_engine
                 // Also neuron need to have 2M neighbors, the addtional synapse will be set as zero weight
                 // Case1 [S0 S1 S2 - SR S5 S6]. SR is removed, [S0 S1 S2 S5 S6 0]
                 // Case2 [S0 S1 SR - S3 S4 S5]. SR is removed, [0 S0 S1 S3 S4 S5]
-                if (synapseIndexOfNN >= numberOfNeighbors / 2)
+                if (synapseIndexOfNN >= (long long)numberOfNeighbors / 2)
                 {
-                    for (long long k = synapseIndexOfNN; k < numberOfNeighbors - 1; ++k)
+                    for (long long k = synapseIndexOfNN; k < (long long)numberOfNeighbors - 1; ++k)
                     {
                         pNNSynapses[k] = pNNSynapses[k + 1];
                     }
@@ -268,7 +295,7 @@ namespace score_engine
                 // Generate a list of neighbor index of current updated neuron NN
                 // Find the location of the inserted neuron in the list of neighbors
                 long long insertedNeuronIdxInNeigborList = -1;
-                for (long long k = 0; k < numberOfNeighbors; k++)
+                for (long long k = 0; k < (long long)numberOfNeighbors; k++)
                 {
                     unsigned long long nnIndex = getNeighborNeuronIndex(updatedNeuronIdx, k);
                     if (nnIndex == insertedNeuronIdx)
@@ -425,8 +452,6 @@ namespace score_engine
         {
             bool isStructureChanged = false;
             unsigned long long population = currentANN.population;
-            Synapse *synapses = currentANN.synapses;
-            Neuron *neurons = currentANN.neurons;
             NeuronType *neuronTypes = currentANN.neuronTypes;
 
             unsigned long long affectedCount = 0;
@@ -510,13 +535,13 @@ namespace score_engine
             return isStructureChanged;
         }
 
-        // Remove neurons and synapses that do not affect the ANN
-        void cleanANN()
+        // Remove neurons and synapses that do not affect the ANN, return true if any neuron is removed
+        bool cleanANN()
         {
             // No removal. First scan and probagate to be removed neurons
             if (!scanRedundantNeurons())
             {
-                return;
+                return false;
             }
 
             // Remove neurons
@@ -534,14 +559,23 @@ namespace score_engine
                     neuronIdx++;
                 }
             }
+            return true;
         }
 
-        void processTick()
+        // Run one tick and write the new values in place, the kernel only reads the bitmaps of the previous tick.
+        // Return true when the simulation can stop: no neuron changed or no output neuron is zero.
+        bool processTick()
         {
             unsigned long long population = currentANN.population;
+            Neuron *neurons = currentANN.neurons;
+            const NeuronType *neuronTypes = currentANN.neuronTypes;
 
-            unsigned char *pPaddingNeuronMinus = currentANN.neuronMinus1s;
-            unsigned char *pPaddingNeuronPlus = currentANN.neuronPlus1s;
+            // Exit conditions are tracked while the new values are stored
+            unsigned char changedNeurons = 0;
+            unsigned char zeroOutputNeurons = 0;
+
+            unsigned char *pPaddingNeuronMinus = neuronMinus1s;
+            unsigned char *pPaddingNeuronPlus = neuronPlus1s;
 
             unsigned char *pPaddingSynapseMinus = currentANN.synapseMinus1s;
             unsigned char *pPaddingSynapsePlus = currentANN.synapsePlus1s;
@@ -618,13 +652,15 @@ namespace score_engine
                     // Reduce to scalar and compute neuron value
                     int score = (int)_mm512_reduce_add_epi64(_mm512_sub_epi64(plusPopulation, minusPopulation));
                     char neuronValue = (score > 0) - (score < 0);
-                    neuronValueBuffer[current_n] = neuronValue;
+                    changedNeurons |= (unsigned char)(neurons[current_n] ^ neuronValue);
+                    zeroOutputNeurons |= (unsigned char)((neuronTypes[current_n] == OUTPUT_NEURON_TYPE) & (neuronValue == 0));
+                    neurons[current_n] = neuronValue;
 
                     // Update the neuron positive and negative bitmaps
                     unsigned char nNextNeg = neuronValue < 0 ? 1 : 0;
                     unsigned char nNextPos = neuronValue > 0 ? 1 : 0;
-                    setBitValue(currentANN.nextneuronMinus1s, current_n + radius, nNextNeg);
-                    setBitValue(currentANN.nextNeuronPlus1s, current_n + radius, nNextPos);
+                    setBitValue(nextNeuronMinus1s, current_n + radius, nNextNeg);
+                    setBitValue(nextNeuronPlus1s, current_n + radius, nNextPos);
                 }
             }
 
@@ -671,70 +707,159 @@ namespace score_engine
 
                 score = (int)_mm512_reduce_add_epi64(_mm512_sub_epi64(plusPopulation, minusPopulation));
                 neuronValue = (score > 0) - (score < 0);
-                neuronValueBuffer[n] = neuronValue;
+                changedNeurons |= (unsigned char)(neurons[n] ^ neuronValue);
+                zeroOutputNeurons |= (unsigned char)((neuronTypes[n] == OUTPUT_NEURON_TYPE) & (neuronValue == 0));
+                neurons[n] = neuronValue;
 
                 unsigned char nNextNeg = neuronValue < 0 ? 1 : 0;
                 unsigned char nNextPos = neuronValue > 0 ? 1 : 0;
-                setBitValue(currentANN.nextneuronMinus1s, n + radius, nNextNeg);
-                setBitValue(currentANN.nextNeuronPlus1s, n + radius, nNextPos);
+                setBitValue(nextNeuronMinus1s, n + radius, nNextNeg);
+                setBitValue(nextNeuronPlus1s, n + radius, nNextPos);
             }
 #else
-            constexpr unsigned long long chunks = incommingSynapsesPitch >> 8;
-            for (unsigned long long n = 0; n < population; ++n, pPaddingSynapsePlus += incommingSynapseBatchSize, pPaddingSynapseMinus += incommingSynapseBatchSize)
+#if defined(SCORE_RUNTIME_AVX512_POPCNT)
+            if (useAvx512Popcnt())
             {
-                char neuronValue = 0;
-                int score = 0;
-                unsigned char *pSynapsePlus = pPaddingSynapsePlus;
-                unsigned char *pSynapseMinus = pPaddingSynapseMinus;
-
-                int synapseBlkIdx = 0; // blk index of synapse
-                int neuronBlkIdx = 0;
-                for (unsigned blk = 0; blk < chunks; ++blk, synapseBlkIdx += BATCH_SIZE, neuronBlkIdx += BATCH_SIZE_X8)
+                processNeuronsAvx512Popcnt(population, changedNeurons, zeroOutputNeurons);
+            }
+            else
+#endif
+            {
+                constexpr unsigned long long chunks = incommingSynapsesPitch >> 8;
+                static_assert(chunks * 8 <= 255, "Per byte popcounts of all chunks must fit in a byte");
+                for (unsigned long long n = 0; n < population; ++n, pPaddingSynapsePlus += incommingSynapseBatchSize, pPaddingSynapseMinus += incommingSynapseBatchSize)
                 {
-                    // Process 256bits at once, neigbor shilf 64 bytes = 256 bits
-                    const __m256i synapsePlus = _mm256_loadu_si256((const __m256i *)(pPaddingSynapsePlus + synapseBlkIdx));
-                    const __m256i synapseMinus = _mm256_loadu_si256((const __m256i *)(pPaddingSynapseMinus + synapseBlkIdx));
+                    char neuronValue = 0;
+                    int score = 0;
 
-                    __m256i neuronPlus = load256Bits(pPaddingNeuronPlus, n + neuronBlkIdx);
-                    __m256i neuronMinus = load256Bits(pPaddingNeuronMinus, n + neuronBlkIdx);
+                    // Per byte popcounts, widened once per neuron
+                    __m256i plusPopulation = _mm256_setzero_si256();
+                    __m256i minusPopulation = _mm256_setzero_si256();
 
-                    // Compare the negative and possitive parts
-                    __m256i plus = _mm256_or_si256(_mm256_and_si256(neuronPlus, synapsePlus),
-                                                   _mm256_and_si256(neuronMinus, synapseMinus));
-                    __m256i minus = _mm256_or_si256(_mm256_and_si256(neuronPlus, synapseMinus),
-                                                    _mm256_and_si256(neuronMinus, synapsePlus));
+                    int synapseBlkIdx = 0; // blk index of synapse
+                    int neuronBlkIdx = 0;
+                    for (unsigned blk = 0; blk < chunks; ++blk, synapseBlkIdx += BATCH_SIZE, neuronBlkIdx += BATCH_SIZE_X8)
+                    {
+                        // Process 256bits at once, neigbor shilf 64 bytes = 256 bits
+                        const __m256i synapsePlus = _mm256_loadu_si256((const __m256i *)(pPaddingSynapsePlus + synapseBlkIdx));
+                        const __m256i synapseMinus = _mm256_loadu_si256((const __m256i *)(pPaddingSynapseMinus + synapseBlkIdx));
 
-                    score += popcnt256(plus) - popcnt256(minus);
-                }
+                        __m256i neuronPlus = load256Bits(pPaddingNeuronPlus, n + neuronBlkIdx);
+                        __m256i neuronMinus = load256Bits(pPaddingNeuronMinus, n + neuronBlkIdx);
 
-                neuronValue = (score > 0) - (score < 0);
-                neuronValueBuffer[n] = neuronValue;
+                        // Compare the negative and possitive parts
+                        __m256i plus = _mm256_or_si256(_mm256_and_si256(neuronPlus, synapsePlus),
+                                                       _mm256_and_si256(neuronMinus, synapseMinus));
+                        __m256i minus = _mm256_or_si256(_mm256_and_si256(neuronPlus, synapseMinus),
+                                                        _mm256_and_si256(neuronMinus, synapsePlus));
 
-                // Update the neuron positive and negative
-                unsigned char nNextNeg = neuronValue < 0 ? 1 : 0;
-                unsigned char nNextPos = neuronValue > 0 ? 1 : 0;
-                setBitValue(currentANN.nextneuronMinus1s, n + radius, nNextNeg);
-                setBitValue(currentANN.nextNeuronPlus1s, n + radius, nNextPos);
+                        plusPopulation = _mm256_add_epi8(plusPopulation, popcnt256Epi8(plus));
+                        minusPopulation = _mm256_add_epi8(minusPopulation, popcnt256Epi8(minus));
+                    }
+                    const __m256i zero = _mm256_setzero_si256();
+                    score = (int)reduceAdd256Epi64(_mm256_sub_epi64(_mm256_sad_epu8(plusPopulation, zero), _mm256_sad_epu8(minusPopulation, zero)));
+
+                    neuronValue = (score > 0) - (score < 0);
+                    changedNeurons |= (unsigned char)(neurons[n] ^ neuronValue);
+                    zeroOutputNeurons |= (unsigned char)((neuronTypes[n] == OUTPUT_NEURON_TYPE) & (neuronValue == 0));
+                    neurons[n] = neuronValue;
+
+                    // Update the neuron positive and negative
+                    unsigned char nNextNeg = neuronValue < 0 ? 1 : 0;
+                    unsigned char nNextPos = neuronValue > 0 ? 1 : 0;
+                    setBitValue(nextNeuronMinus1s, n + radius, nNextNeg);
+                    setBitValue(nextNeuronPlus1s, n + radius, nNextPos);
+                }
             }
 #endif
 
-            copyMem(currentANN.neurons, neuronValueBuffer, population * sizeof(Neuron));
-            copyMem(currentANN.neuronMinus1s, currentANN.nextneuronMinus1s, sizeof(currentANN.neuronMinus1s));
-            copyMem(currentANN.neuronPlus1s, currentANN.nextNeuronPlus1s, sizeof(currentANN.neuronPlus1s));
+            swapNeuronBitmaps();
+
+            return (changedNeurons == 0) || (zeroOutputNeurons == 0);
         }
 
-        void runTickSimulation()
+#if defined(SCORE_RUNTIME_AVX512_POPCNT)
+        // processTick body for AVX2 builds running on a CPU with AVX-512 popcount. Same AVX2 data layout, a synapse
+        // row is covered by 512-bit blocks and the bytes past the row end are masked off in the last one.
+        SCORE_TARGET_AVX512_POPCNT
+        void processNeuronsAvx512Popcnt(unsigned long long population, unsigned char &changedNeuronsOut, unsigned char &zeroOutputNeuronsOut)
         {
-            unsigned long long population = currentANN.population;
-            Synapse *synapses = currentANN.synapses;
+            constexpr unsigned long long blockSize = 64ULL;
+            constexpr unsigned long long chunks = (incommingSynapseBatchSize + blockSize - 1) / blockSize;
+            constexpr unsigned long long lastChunkBytes = incommingSynapseBatchSize - (chunks - 1) * blockSize;
+            const __mmask64 lastChunkMask = (lastChunkBytes == blockSize) ? ~0ULL : ((1ULL << lastChunkBytes) - 1);
+
             Neuron *neurons = currentANN.neurons;
-            NeuronType *neuronTypes = currentANN.neuronTypes;
+            const NeuronType *neuronTypes = currentANN.neuronTypes;
+            const unsigned char *pPaddingNeuronMinus = neuronMinus1s;
+            const unsigned char *pPaddingNeuronPlus = neuronPlus1s;
+            const unsigned char *pSynapsePlus = currentANN.synapsePlus1s;
+            const unsigned char *pSynapseMinus = currentANN.synapseMinus1s;
+
+            unsigned char changedNeurons = 0;
+            unsigned char zeroOutputNeurons = 0;
+            for (unsigned long long n = 0; n < population; ++n, pSynapsePlus += incommingSynapseBatchSize, pSynapseMinus += incommingSynapseBatchSize)
+            {
+                const unsigned long long byteIndex = n >> 3;
+                const __m512i sh = _mm512_set1_epi64((long long)(n & 7U));
+                const __m512i sh8 = _mm512_set1_epi64((long long)(8U - (n & 7U)));
+
+                __m512i population512 = _mm512_setzero_si512();
+                for (unsigned long long blk = 0; blk < chunks; ++blk)
+                {
+                    const __mmask64 loadMask = (blk + 1 == chunks) ? lastChunkMask : ~0ULL;
+                    const __m512i synapsePlus = _mm512_maskz_loadu_epi8(loadMask, pSynapsePlus + blk * blockSize);
+                    const __m512i synapseMinus = _mm512_maskz_loadu_epi8(loadMask, pSynapseMinus + blk * blockSize);
+
+                    const unsigned char *pNeuronPlus = pPaddingNeuronPlus + byteIndex + blk * blockSize;
+                    const unsigned char *pNeuronMinus = pPaddingNeuronMinus + byteIndex + blk * blockSize;
+                    // Zero-masked forms with a full mask here and in the reduction below: the plain ones start from
+                    // _mm512_undefined, which GCC reports as maybe-uninitialized inside a target attribute function
+                    const __m512i neuronPlus = _mm512_or_si512(_mm512_maskz_srlv_epi64(0xFF, _mm512_loadu_si512((const void *)pNeuronPlus), sh),
+                                                               _mm512_maskz_sllv_epi64(0xFF, _mm512_loadu_si512((const void *)(pNeuronPlus + 1)), sh8));
+                    const __m512i neuronMinus = _mm512_or_si512(_mm512_maskz_srlv_epi64(0xFF, _mm512_loadu_si512((const void *)pNeuronMinus), sh),
+                                                                _mm512_maskz_sllv_epi64(0xFF, _mm512_loadu_si512((const void *)(pNeuronMinus + 1)), sh8));
+
+                    // plus = (nP & sP) | (nM & sM), minus = (nP & sM) | (nM & sP)
+                    const __m512i plus = _mm512_ternarylogic_epi64(neuronPlus, synapsePlus, _mm512_and_si512(neuronMinus, synapseMinus), 234);
+                    const __m512i minus = _mm512_ternarylogic_epi64(neuronPlus, synapseMinus, _mm512_and_si512(neuronMinus, synapsePlus), 234);
+
+                    population512 = _mm512_add_epi64(population512, _mm512_sub_epi64(_mm512_popcnt_epi64(plus), _mm512_popcnt_epi64(minus)));
+                }
+
+                const int score = (int)reduceAdd256Epi64(_mm256_add_epi64(_mm512_maskz_extracti64x4_epi64(0xF, population512, 0),
+                                                                           _mm512_maskz_extracti64x4_epi64(0xF, population512, 1)));
+                const char neuronValue = (score > 0) - (score < 0);
+                changedNeurons |= (unsigned char)(neurons[n] ^ neuronValue);
+                zeroOutputNeurons |= (unsigned char)((neuronTypes[n] == OUTPUT_NEURON_TYPE) & (neuronValue == 0));
+                neurons[n] = neuronValue;
+
+                setBitValue(nextNeuronMinus1s, n + radius, neuronValue < 0 ? 1 : 0);
+                setBitValue(nextNeuronPlus1s, n + radius, neuronValue > 0 ? 1 : 0);
+            }
+            changedNeuronsOut |= changedNeurons;
+            zeroOutputNeuronsOut |= zeroOutputNeurons;
+        }
+#endif
+
+        // The bitmaps written by a tick become the input of the next one
+        void swapNeuronBitmaps()
+        {
+            unsigned char *tmp = neuronPlus1s;
+            neuronPlus1s = nextNeuronPlus1s;
+            nextNeuronPlus1s = tmp;
 
-            // Save the neuron value for comparison
-            copyMem(previousNeuronValue, neurons, population * sizeof(Neuron));
+            tmp = neuronMinus1s;
+            neuronMinus1s = nextNeuronMinus1s;
+            nextNeuronMinus1s = tmp;
+        }
+
+        // Compute the incomming synapse of each neurons and their masks from scratch
+        void buildIncommingSynapses()
+        {
+            unsigned long long population = currentANN.population;
             {
-                // PROFILE_NAMED_SCOPE("convertSynapse");
-                //  Compute the incomming synapse of each neurons
+                PROFILE_NAMED_SCOPE("convertSynapse");
                 setMem(paddingIncommingSynapses, sizeof(paddingIncommingSynapses), 0);
                 for (unsigned long long n = 0; n < population; ++n)
                 {
@@ -750,7 +875,7 @@ namespace score_engine
 
                     // paddingIncommingSynapses[n * incommingSynapsesPitch + radius] = 0;
 
-                    for (long long m = radius; m < numberOfNeighbors; m++)
+                    for (long long m = radius; m < (long long)numberOfNeighbors; m++)
                     {
                         Synapse synapseWeight = kSynapses[m];
                         unsigned long long nnIndex = clampNeuronIndex(n + m + 1, -radius);
@@ -759,146 +884,85 @@ namespace score_engine
                 }
             }
 
-            // Prepare masks
             {
-                // PROFILE_NAMED_SCOPE("prepareMask");
-                packNegPosWithPadding(currentANN.neurons,
-                                      population,
-                                      radius,
-                                      currentANN.neuronMinus1s,
-                                      currentANN.neuronPlus1s);
-
+                PROFILE_NAMED_SCOPE("prepareSynapseMask");
                 packNegPosWithPadding(paddingIncommingSynapses,
                                       incommingSynapsesPitch * population,
                                       0,
                                       currentANN.synapseMinus1s,
                                       currentANN.synapsePlus1s);
             }
-
-            {
-                // PROFILE_NAMED_SCOPE("processTickLoop");
-                for (unsigned long long tick = 0; tick < numberOfTicks; ++tick)
-                {
-                    processTick();
-                    // Check exit conditions:
-                    // - N ticks have passed (already in for loop)
-                    // - All neuron values are unchanged
-                    // - All output neurons have non-zero values
-
-                    if (areAllNeuronsUnchanged((const char *)previousNeuronValue, (const char *)neurons, population) || areAllNeuronsZeros((const char *)neurons, (const char *)neuronTypes, population))
-                    {
-                        break;
-                    }
-
-                    // Copy the neuron value
-                    copyMem(previousNeuronValue, neurons, population * sizeof(Neuron));
-                }
-            }
+            isIncommingSynapsesValid = true;
         }
 
-        bool areAllNeuronsZeros(
-            const char *neurons,
-            const char *neuronTypes,
-            unsigned long long population)
+        // Patch the incomming synapse entry and mask bits of currentANN.synapses[synapseIdx], same layout as buildIncommingSynapses
+        void updateIncommingSynapse(unsigned long long synapseIdx)
         {
-
-#if defined(__AVX512F__)
-            const __m512i zero = _mm512_setzero_si512();
-            const __m512i typeOutput = _mm512_set1_epi8(OUTPUT_NEURON_TYPE);
-
-            unsigned long long i = 0;
-            for (; i + BATCH_SIZE <= population; i += BATCH_SIZE)
+            if (!isIncommingSynapsesValid)
             {
-                __m512i cur = _mm512_loadu_si512((const void *)(neurons + i));
-                __m512i types = _mm512_loadu_si512((const void *)(neuronTypes + i));
-
-                __mmask64 type_mask = _mm512_cmpeq_epi8_mask(types, typeOutput);
-                __mmask64 zero_mask = _mm512_cmpeq_epi8_mask(cur, zero);
-
-                if (type_mask & zero_mask)
-                    return false;
+                return;
             }
-#else
-            const __m256i zero = _mm256_setzero_si256();
-            const __m256i typeOutput = _mm256_set1_epi8(OUTPUT_NEURON_TYPE);
 
-            unsigned long long i = 0;
-            for (; i + BATCH_SIZE <= population; i += BATCH_SIZE)
+            const unsigned long long n = synapseIdx / numberOfNeighbors;
+            const long long m = (long long)(synapseIdx % numberOfNeighbors);
+            unsigned long long nnIndex = 0;
+            unsigned long long column = 0;
+            if (m < radius)
             {
-                __m256i cur = _mm256_loadu_si256((const __m256i *)(neurons + i));
-                __m256i types = _mm256_loadu_si256((const __m256i *)(neuronTypes + i));
-
-                // Compare for type == OUTPUT
-                __m256i type_cmp = _mm256_cmpeq_epi8(types, typeOutput);
-                int type_mask = _mm256_movemask_epi8(type_cmp);
-
-                // Compare for neuron == 0
-                __m256i zero_cmp = _mm256_cmpeq_epi8(cur, zero);
-                int zero_mask = _mm256_movemask_epi8(zero_cmp);
-
-                // If both masks overlap → some output neuron is zero
-                if (type_mask & zero_mask)
-                {
-                    return false;
-                }
+                nnIndex = clampNeuronIndex(n + m, -radius);
+                column = numberOfNeighbors - m;
             }
-
-#endif
-            for (; i < population; i++)
+            else
             {
-                // Neuron unchanged check
-                if (neuronTypes[i] == OUTPUT_NEURON_TYPE && neurons[i] == 0)
-                {
-                    return false;
-                }
+                nnIndex = clampNeuronIndex(n + m + 1, -radius);
+                column = numberOfNeighbors - m - 1;
             }
 
-            return true;
+            const Synapse synapseWeight = currentANN.synapses[synapseIdx];
+            const unsigned long long bitIdx = nnIndex * incommingSynapsesPitch + column;
+            paddingIncommingSynapses[bitIdx] = synapseWeight;
+            setBitValue(currentANN.synapseMinus1s, bitIdx, synapseWeight < 0 ? 1 : 0);
+            setBitValue(currentANN.synapsePlus1s, bitIdx, synapseWeight > 0 ? 1 : 0);
         }
 
-        bool areAllNeuronsUnchanged(
-            const char *previousNeuronValue,
-            const char *neurons,
-            unsigned long long population)
+        void runTickSimulation()
         {
-            unsigned long long i = 0;
-            for (; i + BATCH_SIZE <= population; i += BATCH_SIZE)
-            {
-
-#if defined(__AVX512F__)
-                __m512i prev = _mm512_loadu_si512((const void *)(previousNeuronValue + i));
-                __m512i cur = _mm512_loadu_si512((const void *)(neurons + i));
-
-                __mmask64 neq_mask = _mm512_cmpneq_epi8_mask(prev, cur);
-                if (neq_mask)
-                {
-                    return false;
-                }
-#else
-                __m256i v_prev = _mm256_loadu_si256((const __m256i *)(previousNeuronValue + i));
-                __m256i v_curr = _mm256_loadu_si256((const __m256i *)(neurons + i));
-                __m256i cmp = _mm256_cmpeq_epi8(v_prev, v_curr);
+            unsigned long long population = currentANN.population;
 
-                int mask = _mm256_movemask_epi8(cmp);
+            // Only rebuilt after a structural change, weight changes were already patched in
+            if (!isIncommingSynapsesValid)
+            {
+                buildIncommingSynapses();
+            }
 
-                // -1 means all bytes equal
-                if (mask != -1)
-                {
-                    return false;
-                }
-#endif
+            // Prepare masks
+            {
+                PROFILE_NAMED_SCOPE("prepareMask");
+                packNegPosWithPadding(currentANN.neurons,
+                                      population,
+                                      radius,
+                                      currentANN.neuronMinus1s,
+                                      currentANN.neuronPlus1s);
+                neuronMinus1s = currentANN.neuronMinus1s;
+                neuronPlus1s = currentANN.neuronPlus1s;
+                nextNeuronMinus1s = currentANN.nextneuronMinus1s;
+                nextNeuronPlus1s = currentANN.nextNeuronPlus1s;
             }
 
-            for (; i < population; i++)
             {
-                // Neuron unchanged check
-                if (previousNeuronValue[i] != neurons[i])
+                PROFILE_NAMED_SCOPE("processTickLoop");
+                for (unsigned long long tick = 0; tick < numberOfTicks; ++tick)
                 {
-                    return false;
+                    // Check exit conditions:
+                    // - N ticks have passed (already in for loop)
+                    // - All neuron values are unchanged
+                    // - All output neurons have non-zero values
+                    if (processTick())
+                    {
+                        break;
+                    }
                 }
             }
-
-            return true;
         }
 
         unsigned int computeNonMatchingOutput()
@@ -1027,7 +1091,6 @@ namespace score_engine
         void initNeuronType()
         {
             unsigned long long population = currentANN.population;
-            Neuron *neurons = currentANN.neurons;
             NeuronType *neuronTypes = currentANN.neuronTypes;
             InitValue *initValue = (InitValue *)paddingInitValue;
 
@@ -1093,12 +1156,13 @@ namespace score_engine
 
             unsigned long long &population = currentANN.population;
             Synapse *synapses = currentANN.synapses;
-            Neuron *neurons = currentANN.neurons;
             InitValue *initValue = (InitValue *)paddingInitValue;
 
             // Initialization
             population = numberOfNeurons;
             removalNeuronsCount = 0;
+            isIncommingSynapsesValid = false;
+            lastMutatedSynapseIdx = -1;
 
             // Synapse weight initialization
             for (unsigned long long i = 0; i < (initNumberOfSynapses / 32); ++i)
@@ -1143,8 +1207,41 @@ namespace score_engine
             return R;
         }
 
+        // Save the mutated currentANN as bestANN.
+        // After a weight mutation the ANNs only differ by neuron values and the mutated synapse.
+        void acceptMutation()
+        {
+            if (lastMutatedSynapseIdx >= 0)
+            {
+                currentANN.copyNeuronsTo(bestANN);
+                bestANN.synapses[lastMutatedSynapseIdx] = currentANN.synapses[lastMutatedSynapseIdx];
+            }
+            else
+            {
+                currentANN.copyDataTo(bestANN);
+            }
+        }
+
+        // Restore currentANN from bestANN, undoing the last mutation
+        void rollbackMutation()
+        {
+            if (lastMutatedSynapseIdx >= 0)
+            {
+                bestANN.copyNeuronsTo(currentANN);
+                currentANN.synapses[lastMutatedSynapseIdx] = bestANN.synapses[lastMutatedSynapseIdx];
+                updateIncommingSynapse(lastMutatedSynapseIdx);
+            }
+            else
+            {
+                bestANN.copyDataTo(currentANN);
+                isIncommingSynapsesValid = false;
+            }
+        }
+
         // Main function for mining
-        unsigned int computeScore(const unsigned char *publicKey, const unsigned char *nonce, const unsigned char *pRandom2Pool)
+        // With a non-zero scoreThreshold the search stops as soon as the score reaches it, the result is then only
+        // a lower bound of the exact score (bestR never increases, so the score never drops afterwards)
+        unsigned int computeScore(const unsigned char *publicKey, const unsigned char *nonce, const unsigned char *pRandom2Pool, unsigned int scoreThreshold = 0)
         {
             // Setup the random starting point
             initializeRandom2(publicKey, nonce, pRandom2Pool);
@@ -1154,6 +1251,10 @@ namespace score_engine
 
             for (unsigned long long s = 0; s < numberOfMutations; ++s)
             {
+                if (scoreThreshold && numberOfOutputNeurons - bestR >= scoreThreshold)
+                {
+                    break;
+                }
 
                 // Do the mutation
                 mutate(s);
@@ -1172,16 +1273,14 @@ namespace score_engine
                 if (R > bestR)
                 {
                     // Roll back
-                    // copyMem(&currentANN, &bestANN, sizeof(ANN));
-                    bestANN.copyDataTo(currentANN);
+                    rollbackMutation();
                 }
                 else
                 {
                     bestR = R;
 
                     // Better R. Save the state
-                    // copyMem(&bestANN, &currentANN, sizeof(ANN));
-                    currentANN.copyDataTo(bestANN);
+                    acceptMutation();
                 }
 
                 // ASSERT(bestANN.population <= populationThreshold);
@@ -1202,6 +1301,17 @@ namespace score_engine
                 requestedOutput,
                 requestedSizeInBytes);
         }
+
+        // 32-byte digest of the neurons, neuron types and synapses of the best network the last computeScore kept,
+        // cpp/tools/score_vectors_gen.cc computes the same one
+        void getBestNetworkDigest(unsigned char *digest)
+        {
+            unsigned char parts[3][32];
+            KangarooTwelve((const unsigned char *)bestANN.neurons, (unsigned int)(bestANN.population * sizeof(Neuron)), parts[0], 32);
+            KangarooTwelve(bestANN.neuronTypes, (unsigned int)(bestANN.population * sizeof(NeuronType)), parts[1], 32);
+            KangarooTwelve((const unsigned char *)bestANN.synapses, (unsigned int)(bestANN.population * numberOfNeighbors * sizeof(Synapse)), parts[2], 32);
+            KangarooTwelve(parts[0], sizeof(parts), digest, 32);
+        }
     };
 
 }
\ No newline at end of file
@@ -1,17 +1,30 @@
 #pragma once
 
 #include <cstdio>
+#include <immintrin.h>
+#include "profiler.hpp"
+
+// Locks are plain volatile chars (0 = free, 1 = taken), as in the qubic core tree.
+// Test-and-test-and-set: spin on a plain read while taken, so waiters do not bounce the cache line.
 
 // Acquire lock, may block
-#define ACQUIRE(lock)
+#define ACQUIRE(lock)                                                  \
+    do                                                                 \
+    {                                                                  \
+        while (__atomic_exchange_n(&(lock), 1, __ATOMIC_ACQUIRE))      \
+        {                                                              \
+            while (lock)                                               \
+            {                                                          \
+                _mm_pause();                                           \
+            }                                                          \
+        }                                                              \
+    } while (0)
 
 // Try to acquire lock and return if successful (without blocking)
-#define TRY_ACQUIRE(lock)
+#define TRY_ACQUIRE(lock) (!(lock) && !__atomic_exchange_n(&(lock), 1, __ATOMIC_ACQUIRE))
 
 // Release lock
-#define RELEASE(lock)
-
-#define PROFILE_SCOPE()
+#define RELEASE(lock) __atomic_store_n(&(lock), 0, __ATOMIC_RELEASE)
 
 #define ASSERT(condition)
 
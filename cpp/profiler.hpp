@@ -0,0 +1,158 @@
+#pragma once
+
+#include "public_settings.hpp"
+
+// PROFILE_SCOPE() / PROFILE_NAMED_SCOPE(name) count calls and rdtsc cycles of the enclosing scope.
+// Compiled out unless USE_PROFILING is set. Cycles are inclusive, a scope nested in another one is counted in both.
+#if USE_PROFILING
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <x86intrin.h>
+
+#define MAX_NUMBER_OF_PROFILE_SCOPES 64
+
+struct ProfileCounters
+{
+    // Only written by the owning thread, relaxed atomics so getProfile() can read them without a lock
+    std::atomic<unsigned long long> calls[MAX_NUMBER_OF_PROFILE_SCOPES];
+    std::atomic<unsigned long long> cycles[MAX_NUMBER_OF_PROFILE_SCOPES];
+
+    ProfileCounters()
+    {
+        for (unsigned long long i = 0; i < MAX_NUMBER_OF_PROFILE_SCOPES; i++)
+        {
+            calls[i].store(0, std::memory_order_relaxed);
+            cycles[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+struct ProfileEntry
+{
+    std::string name;
+    unsigned long long calls;
+    unsigned long long cycles;
+};
+
+struct Profiler
+{
+    // Scope names by id, ids are handed out once per scope site
+    static inline std::mutex mutex;
+    static inline const char *scopeNames[MAX_NUMBER_OF_PROFILE_SCOPES];
+    static inline std::atomic<unsigned int> numberOfScopes{0};
+
+    // Counters of the running threads, plus what exited threads left behind
+    static inline std::vector<ProfileCounters *> threadCounters;
+    static inline ProfileCounters retiredCounters;
+
+    // Registers the calling thread on first use and folds its counts into retiredCounters when it exits
+    struct ThreadCountersOwner
+    {
+        ProfileCounters counters;
+
+        ThreadCountersOwner()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threadCounters.push_back(&counters);
+        }
+
+        ~ThreadCountersOwner()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (unsigned long long i = 0; i < MAX_NUMBER_OF_PROFILE_SCOPES; i++)
+            {
+                retiredCounters.calls[i].fetch_add(counters.calls[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                retiredCounters.cycles[i].fetch_add(counters.cycles[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            for (unsigned long long i = 0; i < threadCounters.size(); i++)
+            {
+                if (threadCounters[i] == &counters)
+                {
+                    threadCounters.erase(threadCounters.begin() + i);
+                    break;
+                }
+            }
+        }
+    };
+
+    static ProfileCounters &getThreadCounters()
+    {
+        static thread_local ThreadCountersOwner owner;
+        return owner.counters;
+    }
+
+    // Scopes past MAX_NUMBER_OF_PROFILE_SCOPES share the last id
+    static unsigned int registerScope(const char *name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        unsigned int id = numberOfScopes.load(std::memory_order_relaxed);
+        if (id >= MAX_NUMBER_OF_PROFILE_SCOPES)
+        {
+            return MAX_NUMBER_OF_PROFILE_SCOPES - 1;
+        }
+        scopeNames[id] = name;
+        numberOfScopes.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    static void add(unsigned int id, unsigned long long cycles)
+    {
+        ProfileCounters &counters = getThreadCounters();
+        // Single writer, a plain load and store is enough
+        counters.calls[id].store(counters.calls[id].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counters.cycles[id].store(counters.cycles[id].load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+    }
+
+    // Totals of every scope over all threads, running or exited
+    static std::vector<ProfileEntry> getProfile()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<ProfileEntry> profile;
+        unsigned int count = numberOfScopes.load(std::memory_order_acquire);
+        for (unsigned int id = 0; id < count; id++)
+        {
+            ProfileEntry entry = {scopeNames[id], retiredCounters.calls[id].load(std::memory_order_relaxed), retiredCounters.cycles[id].load(std::memory_order_relaxed)};
+            for (ProfileCounters *counters : threadCounters)
+            {
+                entry.calls += counters->calls[id].load(std::memory_order_relaxed);
+                entry.cycles += counters->cycles[id].load(std::memory_order_relaxed);
+            }
+            profile.push_back(entry);
+        }
+        return profile;
+    }
+};
+
+struct ProfileScopeId
+{
+    unsigned int id;
+    ProfileScopeId(const char *name) : id(Profiler::registerScope(name)) {}
+};
+
+struct ProfileScopeTimer
+{
+    unsigned int id;
+    unsigned long long begin;
+    ProfileScopeTimer(unsigned int scopeId) : id(scopeId), begin(__rdtsc()) {}
+    ~ProfileScopeTimer()
+    {
+        Profiler::add(id, __rdtsc() - begin);
+    }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_NAMED_SCOPE(name)                                                    \
+    static ProfileScopeId PROFILE_CONCAT(profileScopeId, __LINE__)(name);            \
+    ProfileScopeTimer PROFILE_CONCAT(profileScopeTimer, __LINE__)(PROFILE_CONCAT(profileScopeId, __LINE__).id)
+#define PROFILE_SCOPE() PROFILE_NAMED_SCOPE(__FUNCTION__)
+
+#else
+
+#define PROFILE_SCOPE()
+#define PROFILE_NAMED_SCOPE(name)
+
+#endif
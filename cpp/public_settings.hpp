@@ -5,10 +5,15 @@
 /// Overriding for qatum settings
 
 #define MAX_NUMBER_OF_PROCESSORS 1
-#define NUMBER_OF_SOLUTION_PROCESSORS 1
-#define USE_SCORE_CACHE 0
+#define NUMBER_OF_SOLUTION_PROCESSORS 64 // Compute slots of the shared ScoreFunction, also the max number of verify threads
+#define USE_SCORE_CACHE 1
+#define SCORE_CACHE_SIZE 262144 // Number of cached scores, ~32MB
+#define SCORE_CACHE_COLLISION_RETRIES 8 // Slots per bucket, must divide SCORE_CACHE_SIZE
 
 #define NUMBER_OF_TRANSACTIONS_PER_TICK 1024 // Must be 2^N
+#ifndef USE_PROFILING
+#define USE_PROFILING 0 // rdtsc counters behind PROFILE_SCOPE / PROFILE_NAMED_SCOPE, read with getProfile(). Build with -DUSE_PROFILING=1
+#endif
 
 static constexpr unsigned long long HYPERIDENTITY_NUMBER_OF_INPUT_NEURONS = 512;  // K
 static constexpr unsigned long long HYPERIDENTITY_NUMBER_OF_OUTPUT_NEURONS = 512; // L
@@ -10,6 +10,7 @@
 #include "overload.hpp"
 #include "public_settings.hpp"
 #include "score.hpp"
+#include "random2_pool.hpp"
 #include "solution_struct.hpp"
 
 using namespace std;
@@ -22,50 +23,225 @@ typedef ScoreFunction<
     NUMBER_OF_SOLUTION_PROCESSORS>
     ScoreFunctionType;
 Napi::ThreadSafeFunction tsfn;
-std::atomic_bool stop_thread = false;
-SolutionQueue *solutionQueue = nullptr;
-std::atomic_int64_t threadStartCount = 0;
+SolutionQueue solutionQueue;
+SolutionResultBuffer solutionResultBuffer;
 std::atomic_bool threadStillRunning = false;
-void VerifySolutionThread(SolutionQueue *solutionQueue, ScoreFunctionType *score, unsigned long long threadId)
+Random2PoolCache random2PoolCache;
+
+// CPU slots shared by the verify threads and the sample helpers they borrow. One slot per verify thread started,
+// a verify thread takes one for its own solution and may reserve free ones as helpers, so scoring never runs
+// more threads than verify threads were started.
+struct VerifyThreadBudget
 {
-    score->initMemory();
-    while (true)
-    {
-        if (stop_thread)
-            break;
+    std::atomic<int> freeSlots{0};
+    std::mutex mutex;
+    std::condition_variable slotReleased;
 
-        while (solutionQueue->hasSolution())
+    // Take the slot of a solution, waits while helpers of other solutions hold all of them
+    void acquire()
+    {
+        int free = freeSlots.load();
+        while (true)
         {
-            if (stop_thread)
-                break;
+            if (free > 0)
+            {
+                if (freeSlots.compare_exchange_weak(free, free - 1))
+                {
+                    return;
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            slotReleased.wait(lock, [this]()
+                              { return freeSlots.load() > 0; });
+            free = freeSlots.load();
+        }
+    }
 
-            Solution solution = solutionQueue->getSolution();
+    // Reserve up to maxHelpers free slots, leaving one for each of the queuedSolutions that idle verify threads are
+    // about to pick up. Return how many were reserved.
+    unsigned int reserve(unsigned int maxHelpers, unsigned int queuedSolutions)
+    {
+        int free = freeSlots.load();
+        while (true)
+        {
+            int helpers = std::min((int)maxHelpers, free - (int)queuedSolutions);
+            if (helpers <= 0)
+            {
+                return 0;
+            }
+            if (freeSlots.compare_exchange_weak(free, free - helpers))
+            {
+                return (unsigned int)helpers;
+            }
+        }
+    }
 
-            m256i computorPublicKey;
-            m256i nonce256;
-            m256i seed256;
-            string md5Hash = solution.md5Hash;
-            hexToByte(solution.nonce, nonce256.m256i_u8, 32);
-            hexToByte(solution.miningSeed, seed256.m256i_u8, 32);
-            getPublicKeyFromIdentity((const unsigned char *)solution.computorId, (unsigned char *)&computorPublicKey);
-            score->initMiningData(seed256);
-            unsigned int resultScore = (*score)(0, computorPublicKey, seed256, nonce256);
-            score_engine::AlgoType selectedAlgo = score_engine::getAlgoType(nonce256.m256i_u8);
-            tsfn.BlockingCall([resultScore, md5Hash, selectedAlgo](Napi::Env env, Napi::Function jsCallback)
-                              {
-                                  HandleScope scope(env);
-                                  Object obj = Object::New(env);
-                                  obj.Set("md5Hash", md5Hash);
-                                  obj.Set("resultScore", resultScore);
-                                  obj.Set("algo", static_cast<int>(selectedAlgo));
-                                  jsCallback.Call({obj}); });
+    void release(unsigned int slots)
+    {
+        freeSlots.fetch_add((int)slots);
+        {
+            // Pairs with the predicate check of acquire, a waiter cannot miss this release
+            std::lock_guard<std::mutex> lock(mutex);
         }
+        slotReleased.notify_all();
+    }
+};
+VerifyThreadBudget verifyThreadBudget;
 
-        this_thread::sleep_for(chrono::milliseconds(100));
+string pageSizeToString(unsigned long long pageSize)
+{
+    if (pageSize >= (1ULL << 30))
+    {
+        return to_string(pageSize >> 30) + "GB pages";
+    }
+    if (pageSize >= (1ULL << 20))
+    {
+        return to_string(pageSize >> 20) + "MB pages";
     }
+    return to_string(pageSize >> 10) + "KB pages";
+}
 
-    score->freeMemory();
-    delete score;
+void logRandom2PoolProgress(const Random2Pool &pool, unsigned int percent)
+{
+    if (percent % 25 != 0)
+    {
+        return;
+    }
+    if (percent < 100)
+    {
+        log("node", "building random2 pool " + to_string(percent) + "%");
+        return;
+    }
+    char hex[65];
+    hex[64] = '\0';
+    byteToHex(pool.seed.m256i_u8, hex, 32);
+    log("node", "random2 pool ready for seed " + string(hex) + " (" + (pool.mappedBase ? string("mapped from disk") : pageSizeToString(pool.pageSize)) + ")");
+}
+
+// Shared by all verify threads, each thread claims one of its compute slots per solution
+ScoreFunctionType *scoreFunction = nullptr;
+std::mutex scoreFunctionMutex;
+// The ScoreFunction task queue is a singleton, batches go through it one at a time
+std::mutex verifyBatchMutex;
+
+bool initScoreFunction()
+{
+    std::lock_guard<std::mutex> lock(scoreFunctionMutex);
+    if (scoreFunction)
+    {
+        return true;
+    }
+    // Compute buffers are allocated per slot on first use. Claim the first one now so a failing
+    // allocation and the page size obtained show up at start-up.
+    ScoreFunctionType *function = new ScoreFunctionType();
+    function->initMemory();
+    unsigned long long solutionBufIdx = function->acquireComputeBuffer(0);
+    if (!ScoreFunctionType::isValidComputeBuffer(solutionBufIdx))
+    {
+        delete function;
+        log("error", "failed to allocate score buffers");
+        return false;
+    }
+    function->releaseComputeBuffer(solutionBufIdx);
+    scoreFunction = function;
+    log("node", "score buffers use " + pageSizeToString(scoreFunction->getComputeBufferPageSize(solutionBufIdx)));
+    log("node", string("score kernels use ") + score_engine::getScoreIsa());
+    return true;
+}
+
+void VerifySolutionThread(SolutionQueue *solutionQueue, unsigned long long threadId)
+{
+    Solution solution;
+    while (solutionQueue->pop(solution))
+    {
+        m256i computorPublicKey;
+        m256i nonce256;
+        m256i seed256;
+        copyMem(nonce256.m256i_u8, solution.nonce, 32);
+        copyMem(seed256.m256i_u8, solution.miningSeed, 32);
+        copyMem(computorPublicKey.m256i_u8, solution.computorPublicKey, 32);
+        unsigned int resultScore = score_engine::INVALID_SCORE_VALUE;
+        bool isScoreLowerBound = false;
+        bool isSeedUnprepared = false;
+        if (!isZero(seed256))
+        {
+            // Only seeds prepared through prepareMiningSeed or prepareStrayMiningSeed are served. A solution of any
+            // other seed is handed back unscored, JS queues it again and gets the pool of its seed built.
+            std::shared_ptr<const Random2Pool> pool = random2PoolCache.acquire(seed256);
+            isSeedUnprepared = !pool;
+            if (pool)
+            {
+                // Lend the CPU time of idle verify threads to this solution, only Addition splits its samples
+                verifyThreadBudget.acquire();
+                unsigned int numberOfHelpers = 0;
+                if (score_engine::getAlgoType(nonce256.m256i_u8) == score_engine::AlgoType::Addition)
+                {
+                    numberOfHelpers = verifyThreadBudget.reserve(NUMBER_OF_SOLUTION_PROCESSORS - 1, solutionQueue->size());
+                }
+                resultScore = (*scoreFunction)(threadId, computorPublicKey, seed256, nonce256, pool->data, solution.scoreThreshold, 1 + numberOfHelpers, nullptr, &isScoreLowerBound);
+                verifyThreadBudget.release(1 + numberOfHelpers);
+            }
+        }
+        SolutionResult result;
+        copyMem(result.md5Hash, solution.md5Hash, 16);
+        result.resultScore = resultScore;
+        result.algo = static_cast<int>(score_engine::getAlgoType(nonce256.m256i_u8));
+        result.isScoreLowerBound = isScoreLowerBound;
+        result.isSeedUnprepared = isSeedUnprepared;
+        solutionResultBuffer.push(result);
+    }
+}
+
+struct SolutionResultBatch
+{
+    vector<SolutionResult> results;
+    // md5 hashes of results in hex, 32 chars per result
+    vector<char> md5Hex;
+};
+
+// Deliver verified results to JS one array per batch, without ever blocking on the event loop
+void DispatchSolutionResultThread()
+{
+    vector<SolutionResult> batch;
+    vector<uint8_t> md5Hashes;
+    while (solutionResultBuffer.pop(batch))
+    {
+        SolutionResultBatch *results = new SolutionResultBatch();
+        results->results.swap(batch);
+
+        // One hex pass over the md5 hashes of the whole batch, off the verify threads
+        const unsigned long long count = results->results.size();
+        md5Hashes.resize(count * 16);
+        for (unsigned long long i = 0; i < count; i++)
+        {
+            copyMem(&md5Hashes[i * 16], results->results[i].md5Hash, 16);
+        }
+        results->md5Hex.resize(count * 32 + 1);
+        byteToHexBatch(md5Hashes.data(), results->md5Hex.data(), 16, (int)count);
+
+        napi_status status = tsfn.NonBlockingCall(results, [](Napi::Env env, Napi::Function jsCallback, SolutionResultBatch *batch)
+                                                  {
+                                                      HandleScope scope(env);
+                                                      const vector<SolutionResult> &results = batch->results;
+                                                      Array arr = Array::New(env, results.size());
+                                                      for (unsigned long long i = 0; i < results.size(); i++)
+                                                      {
+                                                          Object obj = Object::New(env);
+                                                          obj.Set("md5Hash", String::New(env, &batch->md5Hex[i * 32], 32));
+                                                          obj.Set("resultScore", results[i].resultScore);
+                                                          obj.Set("algo", results[i].algo);
+                                                          obj.Set("isScoreLowerBound", results[i].isScoreLowerBound);
+                                                          obj.Set("isSeedUnprepared", results[i].isSeedUnprepared);
+                                                          arr.Set((uint32_t)i, obj);
+                                                      }
+                                                      delete batch;
+                                                      jsCallback.Call({arr}); });
+        if (status != napi_ok)
+        {
+            delete results;
+        }
+    }
 }
 
 /////////// Workers ///////////
@@ -191,6 +367,182 @@ private:
     std::string ip;
 };
 
+class PrepareMiningSeedWorker : public AsyncWorker
+{
+public:
+    PrepareMiningSeedWorker(Function &callback, m256i seed, bool isStray)
+        : AsyncWorker(callback), seed(seed), isStray(isStray) {}
+
+    ~PrepareMiningSeedWorker() {}
+
+    void Execute() override
+    {
+        isOk = (isStray ? random2PoolCache.prepareStray(seed) : random2PoolCache.prepare(seed)) != nullptr;
+    }
+
+    void OnOK() override
+    {
+        HandleScope scope(Env());
+        Callback().Call({Boolean::New(Env(), isOk)});
+    }
+
+private:
+    m256i seed;
+    bool isStray;
+    bool isOk;
+};
+
+// Score a batch of solutions through the ScoreFunction task queue, results come back in submission order.
+// The task queue scores against a single random2 pool, so the batch is scored one mining seed at a time.
+// Solutions of seeds that were never prepared come back unscored and flagged isSeedUnprepared.
+class VerifySolutionBatchWorker : public AsyncWorker
+{
+public:
+    VerifySolutionBatchWorker(Function &callback, const Solution *solutions, unsigned long long count, unsigned long long numberOfThreads)
+        : AsyncWorker(callback), solutions(solutions, solutions + count), numberOfThreads(numberOfThreads) {}
+
+    ~VerifySolutionBatchWorker() {}
+
+    void Execute() override
+    {
+        resultScores.assign(solutions.size(), score_engine::INVALID_SCORE_VALUE);
+        isScoreLowerBound.assign(solutions.size(), false);
+        isSeedUnprepared.assign(solutions.size(), false);
+        if (!initScoreFunction())
+        {
+            SetError("failed to allocate score buffers");
+            return;
+        }
+
+        vector<bool> isGrouped(solutions.size(), false);
+        vector<unsigned int> seedGroup;
+        seedGroup.reserve(solutions.size());
+        for (unsigned int first = 0; first < solutions.size(); first++)
+        {
+            if (isGrouped[first])
+            {
+                continue;
+            }
+            m256i seed;
+            copyMem(seed.m256i_u8, solutions[first].miningSeed, 32);
+            seedGroup.clear();
+            for (unsigned int i = first; i < solutions.size(); i++)
+            {
+                if (!isGrouped[i] && memcmp(solutions[i].miningSeed, seed.m256i_u8, 32) == 0)
+                {
+                    isGrouped[i] = true;
+                    seedGroup.push_back(i);
+                }
+            }
+            if (isZero(seed))
+            {
+                continue;
+            }
+            // Unknown seeds are not built here either
+            std::shared_ptr<const Random2Pool> pool = random2PoolCache.acquire(seed);
+            if (pool)
+            {
+                scoreSeedGroup(seed, pool->data, seedGroup);
+                continue;
+            }
+            for (unsigned int i : seedGroup)
+            {
+                isSeedUnprepared[i] = true;
+            }
+        }
+    }
+
+    void OnOK() override
+    {
+        HandleScope scope(Env());
+        Array arr = Array::New(Env(), solutions.size());
+        for (unsigned long long i = 0; i < solutions.size(); i++)
+        {
+            char md5Hash[33];
+            md5Hash[32] = '\0';
+            byteToHex(solutions[i].md5Hash, md5Hash, 16);
+            Object obj = Object::New(Env());
+            obj.Set("md5Hash", md5Hash);
+            obj.Set("resultScore", resultScores[i]);
+            obj.Set("algo", static_cast<int>(score_engine::getAlgoType(solutions[i].nonce)));
+            obj.Set("isScoreLowerBound", (bool)isScoreLowerBound[i]);
+            obj.Set("isSeedUnprepared", (bool)isSeedUnprepared[i]);
+            arr.Set((uint32_t)i, obj);
+        }
+        Callback().Call({arr});
+    }
+
+private:
+    // Score the solutions of one mining seed, seedGroup holds their indices in submission order
+    void scoreSeedGroup(const m256i &seed, const unsigned char *pool, const vector<unsigned int> &seedGroup)
+    {
+        std::lock_guard<std::mutex> lock(verifyBatchMutex);
+        scoreFunction->resetTaskQueue();
+        scoreFunction->initMiningData(seed, pool);
+
+        // Queue the solutions grouped by algo, a compute slot then keeps scoring the same algo back to back
+        // and its multi-MB buffers stay in cache instead of being evicted by the other algo
+        vector<unsigned int> taskOrder;
+        taskOrder.reserve(seedGroup.size());
+        for (score_engine::AlgoType algo : {score_engine::AlgoType::HyperIdentity, score_engine::AlgoType::Addition})
+        {
+            for (unsigned int i : seedGroup)
+            {
+                if (score_engine::getAlgoType(solutions[i].nonce) == algo)
+                {
+                    taskOrder.push_back(i);
+                }
+            }
+        }
+        for (unsigned int solutionIndex : taskOrder)
+        {
+            const Solution &solution = solutions[solutionIndex];
+            m256i computorPublicKey;
+            m256i nonce256;
+            m256i seed256;
+            copyMem(computorPublicKey.m256i_u8, solution.computorPublicKey, 32);
+            copyMem(nonce256.m256i_u8, solution.nonce, 32);
+            copyMem(seed256.m256i_u8, solution.miningSeed, 32);
+            scoreFunction->addTask(computorPublicKey, seed256, nonce256, solution.scoreThreshold);
+        }
+
+        scoreFunction->startProcessTaskQueue();
+        unsigned long long threadCount = std::min(std::min(numberOfThreads, (unsigned long long)NUMBER_OF_SOLUTION_PROCESSORS), (unsigned long long)seedGroup.size());
+        vector<thread> threadsPool;
+        for (unsigned long long i = 1; i < threadCount; i++)
+        {
+            threadsPool.push_back(thread([i]()
+                                         {
+                                             while (scoreFunction->tryProcessSolution(i))
+                                             {
+                                             } }));
+        }
+        while (scoreFunction->tryProcessSolution(0))
+        {
+        }
+        for (auto &thread_1 : threadsPool)
+        {
+            thread_1.join();
+        }
+        scoreFunction->stopProcessTaskQueue();
+
+        for (unsigned int i = 0; i < scoreFunction->getNumberOfTasks(); i++)
+        {
+            resultScores[taskOrder[i]] = scoreFunction->getTaskScore(i);
+            isScoreLowerBound[taskOrder[i]] = scoreFunction->isTaskScoreLowerBound(i);
+        }
+        // The caller releases the pool after this group, do not leave it behind in the ScoreFunction
+        scoreFunction->initMiningData(m256i::zero(), nullptr);
+        scoreFunction->resetTaskQueue();
+    }
+
+    vector<Solution> solutions;
+    vector<unsigned int> resultScores;
+    vector<bool> isScoreLowerBound;
+    vector<bool> isSeedUnprepared;
+    unsigned long long numberOfThreads;
+};
+
 class VerifySolutionWorker : public AsyncWorker
 {
 public:
@@ -213,28 +565,36 @@ public:
 
     void Execute() override
     {
-        threadStillRunning = true;
+        if (numberOfthreads > NUMBER_OF_SOLUTION_PROCESSORS)
+        {
+            log("node", "verify threads are limited to " + to_string(NUMBER_OF_SOLUTION_PROCESSORS));
+            numberOfthreads = NUMBER_OF_SOLUTION_PROCESSORS;
+        }
+        if (!initScoreFunction())
+        {
+            numberOfthreads = 0;
+        }
         log("node", "verify thread started");
         vector<thread> threadsPool;
 
-        if (threadStartCount == 0)
-            solutionQueue = new SolutionQueue();
-
+        thread dispatchThread = thread(DispatchSolutionResultThread);
+        verifyThreadBudget.freeSlots = (int)numberOfthreads;
         for (unsigned long long i = 0; i < numberOfthreads; i++)
         {
-            thread thread_1 = thread(VerifySolutionThread, solutionQueue, new ScoreFunctionType(), i);
+            thread thread_1 = thread(VerifySolutionThread, &solutionQueue, i);
             threadsPool.push_back(move(thread_1));
         }
         for (auto &thread_1 : threadsPool)
         {
             thread_1.join();
         }
+        solutionResultBuffer.close();
+        dispatchThread.join();
+        solutionResultBuffer.open();
 
         tsfn.Release();
         log("node", "verify thread stopped");
         threadStillRunning = false;
-        threadStartCount++;
-        stop_thread = false;
     }
 
     void OnOK() override
@@ -267,8 +627,12 @@ public:
         unsigned char nonce[32];
         unsigned char seed[32];
         __m256i computorPublicKey;
-        hexToByte(nonceHex.c_str(), nonce, 32);
-        hexToByte(seedHex.c_str(), seed, 32);
+        if (nonceHex.length() != 64 || seedHex.length() != 64 || !hexToByte(nonceHex.c_str(), nonce, 32) || !hexToByte(seedHex.c_str(), seed, 32))
+        {
+            isOk = false;
+            log("error", "Invalid solution hex data");
+            return;
+        }
         getPublicKeyFromIdentity((const unsigned char *)computorId.c_str(), (unsigned char *)&computorPublicKey);
         Socket sendSocket;
         isOk = sendSocket.connect(ip.c_str(), PORT) != -1;
@@ -345,6 +709,10 @@ Napi::Value initVerifyThread(const Napi::CallbackInfo &info)
     {
         this_thread::sleep_for(chrono::milliseconds(500));
     }
+    // The previous verify threads are gone, reopen the queue a stopVerifyThread closed before the new ones
+    // start, otherwise they would see it closed and exit at once
+    threadStillRunning = true;
+    solutionQueue.open();
 
     VerifySolutionWorker *wk = new VerifySolutionWorker(num, cb);
     wk->Queue();
@@ -352,12 +720,129 @@ Napi::Value initVerifyThread(const Napi::CallbackInfo &info)
     return info.Env().Undefined();
 }
 
+// The verify threads exit after their current solution. Solutions still in the queue are not drained, they stay
+// there and the threads of the next initVerifyThread score them (SolutionManager keeps them as verifying meanwhile).
 Napi::Value stopVerifyThread(const Napi::CallbackInfo &info)
 {
-    stop_thread = true;
+    solutionQueue.close();
+    return info.Env().Undefined();
+}
+
+m256i seedFromHex(const Napi::CallbackInfo &info)
+{
+    string seedHex = info[0].As<Napi::String>().Utf8Value();
+    if (seedHex.length() != 64)
+    {
+        throw Napi::Error::New(info.Env(), "Invalid input data length");
+    }
+
+    m256i seed;
+    if (!hexToByte(seedHex.c_str(), seed.m256i_u8, 32))
+    {
+        throw Napi::Error::New(info.Env(), "Invalid hex data");
+    }
+    return seed;
+}
+
+// Build the random2 pool of a seed in the background so verification does not stall when it goes live
+Napi::Value prepareMiningSeed(const Napi::CallbackInfo &info)
+{
+    m256i seed = seedFromHex(info);
+    Function cb = info[1].As<Function>();
+
+    // Registered right away, so solutions of this seed pushed before the pool is ready wait for it
+    if (isZero(seed) || !random2PoolCache.expect(seed))
+    {
+        cb.Call({Boolean::New(info.Env(), !isZero(seed))});
+        return info.Env().Undefined();
+    }
+
+    PrepareMiningSeedWorker *wk = new PrepareMiningSeedWorker(cb, seed, false);
+    wk->Queue();
+    return info.Env().Undefined();
+}
+
+// Build the random2 pool of a seed that is not the live one into the stray slot, the live pools stay in place.
+// cb gets false when another stray pool is being built, the caller retries later.
+Napi::Value prepareStrayMiningSeed(const Napi::CallbackInfo &info)
+{
+    m256i seed = seedFromHex(info);
+    Function cb = info[1].As<Function>();
+
+    if (isZero(seed))
+    {
+        cb.Call({Boolean::New(info.Env(), false)});
+        return info.Env().Undefined();
+    }
+
+    PrepareMiningSeedWorker *wk = new PrepareMiningSeedWorker(cb, seed, true);
+    wk->Queue();
+    return info.Env().Undefined();
+}
+
+Napi::Value setRandom2PoolCacheDir(const Napi::CallbackInfo &info)
+{
+    random2PoolCache.setDiskCacheDirectory(info[0].As<Napi::String>().Utf8Value());
     return info.Env().Undefined();
 }
 
+Napi::Value saveScoreCache(const Napi::CallbackInfo &info)
+{
+    int epoch = info[0].As<Napi::Number>().Int32Value();
+    string directory = info[1].As<Napi::String>().Utf8Value();
+    bool isOk = ScoreFunctionType::saveScoreCache(epoch, directory.c_str());
+    return Napi::Boolean::New(info.Env(), isOk);
+}
+
+Napi::Value loadScoreCache(const Napi::CallbackInfo &info)
+{
+    int epoch = info[0].As<Napi::Number>().Int32Value();
+    string directory = info[1].As<Napi::String>().Utf8Value();
+    bool isOk = ScoreFunctionType::loadScoreCache(epoch, directory.c_str());
+    return Napi::Boolean::New(info.Env(), isOk);
+}
+
+Napi::Value getScoreCacheStats(const Napi::CallbackInfo &info)
+{
+    Napi::Object stats = Napi::Object::New(info.Env());
+#if USE_SCORE_CACHE
+    stats.Set("hits", (double)ScoreFunctionType::scoreCache.hits.load());
+    stats.Set("misses", (double)ScoreFunctionType::scoreCache.misses.load());
+    stats.Set("evictions", (double)ScoreFunctionType::scoreCache.evictions.load());
+#else
+    stats.Set("hits", 0);
+    stats.Set("misses", 0);
+    stats.Set("evictions", 0);
+#endif
+    return stats;
+}
+
+// Call count and cycle total of every profiled scope, empty unless built with USE_PROFILING
+Napi::Value getProfile(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+#if USE_PROFILING
+    std::vector<ProfileEntry> profile = Profiler::getProfile();
+    Napi::Array result = Napi::Array::New(env, profile.size());
+    for (unsigned long long i = 0; i < profile.size(); i++)
+    {
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("name", profile[i].name);
+        entry.Set("calls", (double)profile[i].calls);
+        entry.Set("cycles", (double)profile[i].cycles);
+        result.Set(i, entry);
+    }
+    return result;
+#else
+    return Napi::Array::New(env, 0);
+#endif
+}
+
+Napi::Value getScoreIsa(const Napi::CallbackInfo &info)
+{
+    return Napi::String::New(info.Env(), score_engine::getScoreIsa());
+}
+
 Napi::Value initSocket(const Napi::CallbackInfo &info)
 {
 
@@ -413,8 +898,10 @@ Napi::Buffer<unsigned char> prepareSolutionData(const Napi::CallbackInfo &info)
     __m256i computorPublicKey;
     unsigned char nonce[32];
     unsigned char seed[32];
-    hexToByte(nonceHex.c_str(), nonce, 32);
-    hexToByte(seedHex.c_str(), seed, 32);
+    if (!hexToByte(nonceHex.c_str(), nonce, 32) || !hexToByte(seedHex.c_str(), seed, 32))
+    {
+        throw Napi::Error::New(info.Env(), "Invalid hex data");
+    }
     getPublicKeyFromIdentity((const unsigned char *)computorId.c_str(), (unsigned char *)&computorPublicKey);
 
     unsigned char *solutionRaw = new unsigned char[sizeof(RawSolution)];
@@ -435,9 +922,57 @@ Napi::Value pushSolutionToVerifyQueue(const Napi::CallbackInfo &info)
     string nonce = info[1].As<Napi::String>().Utf8Value();
     string computorId = info[2].As<Napi::String>().Utf8Value();
     string md5Hash = info[3].As<Napi::String>().Utf8Value();
+    int scoreThreshold = info[4].As<Napi::Number>().Int32Value();
 
-    solutionQueue->addSolution(Solution(seed.c_str(), nonce.c_str(), computorId.c_str(), md5Hash));
+    if (seed.length() != 64 || nonce.length() != 64 || computorId.length() != 60 || md5Hash.length() < 32)
+    {
+        throw Napi::Error::New(info.Env(), "Invalid input data length");
+    }
 
+    // miningSeed and nonce are adjacent in the record, decode them in one pass
+    static_assert(offsetof(Solution, nonce) == offsetof(Solution, miningSeed) + 32, "nonce must follow miningSeed");
+    Solution solution;
+    string seedAndNonce = seed + nonce;
+    if (!hexToByteBatch(seedAndNonce.c_str(), solution.miningSeed, 32, 2) || !hexToByte(md5Hash.c_str(), solution.md5Hash, 16))
+    {
+        throw Napi::Error::New(info.Env(), "Invalid hex data");
+    }
+    getPublicKeyFromIdentity((const unsigned char *)computorId.c_str(), solution.computorPublicKey);
+    solution.scoreThreshold = scoreThreshold > 0 ? (unsigned int)scoreThreshold : 0;
+    bool isOk = solutionQueue.push(solution);
+
+    return Napi::Boolean::New(info.Env(), isOk);
+}
+
+// Queue a Buffer of packed Solution records, return how many fit into the queue
+Napi::Value pushSolutionsBinary(const Napi::CallbackInfo &info)
+{
+    Napi::Buffer<unsigned char> buffer = info[0].As<Napi::Buffer<unsigned char>>();
+    if (buffer.Length() % sizeof(Solution) != 0)
+    {
+        throw Napi::Error::New(info.Env(), "Invalid input data length");
+    }
+
+    unsigned long long pushed = solutionQueue.push((const Solution *)buffer.Data(), buffer.Length() / sizeof(Solution));
+
+    return Napi::Number::New(info.Env(), pushed);
+}
+
+// Verify up to NUMBER_OF_TRANSACTIONS_PER_TICK packed Solution records at once, cb gets the results in record order
+Napi::Value verifySolutionsBatch(const Napi::CallbackInfo &info)
+{
+    Napi::Buffer<unsigned char> buffer = info[0].As<Napi::Buffer<unsigned char>>();
+    unsigned long long numberOfThreads = info[1].As<Napi::Number>().Int64Value();
+    Function cb = info[2].As<Function>();
+
+    unsigned long long count = buffer.Length() / sizeof(Solution);
+    if (buffer.Length() % sizeof(Solution) != 0 || count == 0 || count > NUMBER_OF_TRANSACTIONS_PER_TICK || numberOfThreads == 0)
+    {
+        throw Napi::Error::New(info.Env(), "Invalid input data length");
+    }
+
+    VerifySolutionBatchWorker *wk = new VerifySolutionBatchWorker(cb, (const Solution *)buffer.Data(), count, numberOfThreads);
+    wk->Queue();
     return info.Env().Undefined();
 }
 
@@ -464,6 +999,8 @@ Napi::Value pay(const Napi::CallbackInfo &info)
 
 Napi::Object Init(Napi::Env env, Napi::Object exports)
 {
+    random2PoolCache.onProgress = logRandom2PoolProgress;
+
     exports.Set(Napi::String::New(env, "initSocket"),
                 Napi::Function::New(env, initSocket));
 
@@ -488,9 +1025,40 @@ Napi::Object Init(Napi::Env env, Napi::Object exports)
     exports.Set(Napi::String::New(env, "stopVerifyThread"),
                 Napi::Function::New(env, stopVerifyThread));
 
+    exports.Set(Napi::String::New(env, "prepareMiningSeed"),
+                Napi::Function::New(env, prepareMiningSeed));
+
+    exports.Set(Napi::String::New(env, "prepareStrayMiningSeed"),
+                Napi::Function::New(env, prepareStrayMiningSeed));
+
+    exports.Set(Napi::String::New(env, "setRandom2PoolCacheDir"),
+                Napi::Function::New(env, setRandom2PoolCacheDir));
+
+    exports.Set(Napi::String::New(env, "saveScoreCache"),
+                Napi::Function::New(env, saveScoreCache));
+
+    exports.Set(Napi::String::New(env, "loadScoreCache"),
+                Napi::Function::New(env, loadScoreCache));
+
+    exports.Set(Napi::String::New(env, "getScoreCacheStats"),
+                Napi::Function::New(env, getScoreCacheStats));
+
+
+    exports.Set(Napi::String::New(env, "getScoreIsa"),
+                Napi::Function::New(env, getScoreIsa));
+
+    exports.Set(Napi::String::New(env, "getProfile"),
+                Napi::Function::New(env, getProfile));
+
     exports.Set(Napi::String::New(env, "pushSolutionToVerifyQueue"),
                 Napi::Function::New(env, pushSolutionToVerifyQueue));
 
+    exports.Set(Napi::String::New(env, "pushSolutionsBinary"),
+                Napi::Function::New(env, pushSolutionsBinary));
+
+    exports.Set(Napi::String::New(env, "verifySolutionsBatch"),
+                Napi::Function::New(env, verifySolutionsBatch));
+
     exports.Set(Napi::String::New(env, "checkScore"),
                 Napi::Function::New(env, checkScore));
 
@@ -0,0 +1,535 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#endif
+#include "overload.hpp"
+#include "public_settings.hpp"
+#include "keyUtils.hpp"
+#include "m256.hpp"
+#include "memory.hpp"
+#include "helper.hpp"
+#include "mining/score_common.hpp"
+
+struct Random2Pool;
+
+// Called with the pool being generated and the percentage done so far
+typedef std::function<void(const Random2Pool &, unsigned int)> Random2PoolProgressCallback;
+
+#if defined(__linux__) && !defined(MADV_POPULATE_WRITE)
+#define MADV_POPULATE_WRITE 23
+#endif
+
+// Same output as score_engine::generateRandom2Pool. The Keccak chain stays serial, but page faults of the
+// 512MB target are taken by a helper thread running ahead of the writer, and the 200-byte states are
+// written with streaming stores so the chain does not wait on read-for-ownership of cold lines.
+static void buildRandom2Pool(const m256i &miningSeed, unsigned char *pool, const std::function<void(unsigned int)> &onProgress)
+{
+    constexpr unsigned long long prefaultChunkSize = 2ULL << 20;
+    constexpr unsigned long long progressSteps = 100;
+    constexpr unsigned long long statesPerStep = (score_engine::POOL_VEC_PADDING_SIZE / score_engine::STATE_SIZE + progressSteps - 1) / progressSteps;
+
+    std::atomic<unsigned long long> written(0);
+    std::atomic_bool stopPrefault(false);
+#ifdef __linux__
+    // MADV_POPULATE_WRITE faults pages in without touching their content, so it is harmless if the writer overtakes
+    const bool usePrefaultThread = std::thread::hardware_concurrency() > 1;
+    std::thread prefaultThread;
+    if (usePrefaultThread)
+    {
+        prefaultThread = std::thread([&]()
+                                     {
+            const unsigned long long pageSize = sysconf(_SC_PAGESIZE);
+            unsigned long long begin = ((unsigned long long)pool + pageSize - 1) & ~(pageSize - 1);
+            const unsigned long long end = ((unsigned long long)pool + score_engine::POOL_VEC_PADDING_SIZE) & ~(pageSize - 1);
+            while (begin < end && !stopPrefault)
+            {
+                // Stay at most a few chunks ahead so the populated pages are still hot in the TLB
+                if (begin > (unsigned long long)pool + written + 8 * prefaultChunkSize)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                unsigned long long length = std::min(prefaultChunkSize, end - begin);
+                if (madvise((void *)begin, length, MADV_POPULATE_WRITE) != 0)
+                {
+                    break;
+                }
+                begin += length;
+            } });
+    }
+#endif
+
+    unsigned long long state[score_engine::STATE_SIZE / 8];
+    copyMem(state, miningSeed.m256i_u8, 32);
+    setMem((unsigned char *)state + 32, score_engine::STATE_SIZE - 32, 0);
+
+    unsigned long long statesInStep = 0;
+    unsigned int percent = 0;
+    for (unsigned long long i = 0; i < score_engine::POOL_VEC_PADDING_SIZE; i += score_engine::STATE_SIZE)
+    {
+        KeccakP1600_Permute_12rounds((unsigned char *)state);
+        long long *dst = (long long *)&pool[i];
+        for (unsigned long long j = 0; j < score_engine::STATE_SIZE / 8; j++)
+        {
+            _mm_stream_si64(dst + j, (long long)state[j]);
+        }
+
+        if (++statesInStep == statesPerStep)
+        {
+            statesInStep = 0;
+            written.store(i + score_engine::STATE_SIZE, std::memory_order_relaxed);
+            if (onProgress && percent + 1 < progressSteps)
+            {
+                onProgress(++percent);
+            }
+        }
+    }
+    _mm_sfence();
+
+    stopPrefault = true;
+#ifdef __linux__
+    if (usePrefaultThread)
+    {
+        prefaultThread.join();
+    }
+#endif
+    if (onProgress)
+    {
+        onProgress(progressSteps);
+    }
+}
+
+// Layout of an on-disk pool: this header padded to one page, followed by POOL_VEC_PADDING_SIZE bytes of pool
+struct Random2PoolFileHeader
+{
+    char magic[8];
+    unsigned long long version;
+    unsigned long long poolSize;
+    unsigned long long checksum;
+    m256i seed;
+};
+static constexpr char RANDOM2_POOL_FILE_MAGIC[8] = {'Q', 'R', 'A', 'N', 'D', '2', 'P', 'L'};
+static constexpr unsigned long long RANDOM2_POOL_FILE_VERSION = 1;
+static constexpr unsigned long long RANDOM2_POOL_FILE_DATA_OFFSET = 4096;
+
+// 4-lane multiply-xor hash of the pool words, lanes are independent to keep the loop throughput bound
+static unsigned long long random2PoolChecksum(const unsigned char *pool)
+{
+    const unsigned long long *words = (const unsigned long long *)pool;
+    const unsigned long long numberOfWords = score_engine::POOL_VEC_PADDING_SIZE / 8;
+    unsigned long long h[4] = {0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL, 0x27D4EB2F165667C5ULL};
+    unsigned long long i = 0;
+    for (; i + 4 <= numberOfWords; i += 4)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            h[j] = (h[j] ^ words[i + j]) * 0x100000001B3ULL;
+        }
+    }
+    for (; i < numberOfWords; i++)
+    {
+        h[0] = (h[0] ^ words[i]) * 0x100000001B3ULL;
+    }
+    return h[0] ^ ROL64(h[1], 16) ^ ROL64(h[2], 32) ^ ROL64(h[3], 48);
+}
+
+// Random2 pool of one mining seed, shared read-only by every verify thread
+struct Random2Pool
+{
+    m256i seed;
+    const unsigned char *data;
+
+    // Page size backing data, 0 when data lives in a read-only mapping of a pool file
+    unsigned long long pageSize;
+    void *mappedBase;
+    unsigned long long mappedSize;
+
+    Random2Pool(const m256i &miningSeed)
+    {
+        seed = miningSeed;
+        data = nullptr;
+        pageSize = 0;
+        mappedBase = nullptr;
+        mappedSize = 0;
+    }
+
+    ~Random2Pool()
+    {
+#ifdef __linux__
+        if (mappedBase)
+        {
+            munmap(mappedBase, mappedSize);
+            return;
+        }
+#endif
+        if (data)
+        {
+            freeLargePages((void *)data, score_engine::POOL_VEC_PADDING_SIZE, pageSize);
+        }
+    }
+
+    // random2 reads are scattered over the whole pool, so it is put on huge pages when the system has them
+    bool build(const Random2PoolProgressCallback &onProgress = nullptr)
+    {
+        unsigned char *pool;
+        if (!allocateLargePages(score_engine::POOL_VEC_PADDING_SIZE, (void **)&pool, &pageSize))
+        {
+            return false;
+        }
+        data = pool;
+        buildRandom2Pool(seed, pool, [&](unsigned int percent)
+                         {
+            if (onProgress)
+            {
+                onProgress(*this, percent);
+            } });
+        return true;
+    }
+
+    static std::string fileName(const m256i &miningSeed)
+    {
+        char hex[65];
+        hex[64] = '\0';
+        byteToHex(miningSeed.m256i_u8, hex, 32);
+        return "random2-" + std::string(hex) + ".pool";
+    }
+
+    // Map a pool file written by save(), rejecting it unless header, seed and checksum all match
+    bool load(const std::string &directory)
+    {
+#ifdef __linux__
+        std::string path = directory + "/" + fileName(seed);
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        const unsigned long long fileSize = RANDOM2_POOL_FILE_DATA_OFFSET + score_engine::POOL_VEC_PADDING_SIZE;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (unsigned long long)st.st_size != fileSize)
+        {
+            close(fd);
+            return false;
+        }
+        void *base = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED)
+        {
+            return false;
+        }
+
+        const Random2PoolFileHeader *header = (const Random2PoolFileHeader *)base;
+        const unsigned char *pool = (const unsigned char *)base + RANDOM2_POOL_FILE_DATA_OFFSET;
+        if (memcmp(header->magic, RANDOM2_POOL_FILE_MAGIC, sizeof(header->magic)) != 0 || header->version != RANDOM2_POOL_FILE_VERSION || header->poolSize != score_engine::POOL_VEC_PADDING_SIZE || header->seed != seed || header->checksum != random2PoolChecksum(pool))
+        {
+            munmap(base, fileSize);
+            return false;
+        }
+        madvise(base, fileSize, MADV_RANDOM);
+
+        mappedBase = base;
+        mappedSize = fileSize;
+        data = pool;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Write the pool to directory, going through a temporary file so readers never see a partial pool
+    bool save(const std::string &directory) const
+    {
+#ifdef __linux__
+        std::string path = directory + "/" + fileName(seed);
+        std::string tmpPath = path + ".tmp";
+        int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        unsigned char headerPage[RANDOM2_POOL_FILE_DATA_OFFSET];
+        setMem(headerPage, sizeof(headerPage), 0);
+        Random2PoolFileHeader *header = (Random2PoolFileHeader *)headerPage;
+        copyMem(header->magic, RANDOM2_POOL_FILE_MAGIC, sizeof(header->magic));
+        header->version = RANDOM2_POOL_FILE_VERSION;
+        header->poolSize = score_engine::POOL_VEC_PADDING_SIZE;
+        header->checksum = random2PoolChecksum(data);
+        header->seed = seed;
+
+        bool isOk = write(fd, headerPage, sizeof(headerPage)) == sizeof(headerPage);
+        unsigned long long offset = 0;
+        while (isOk && offset < score_engine::POOL_VEC_PADDING_SIZE)
+        {
+            ssize_t n = write(fd, data + offset, std::min<unsigned long long>(score_engine::POOL_VEC_PADDING_SIZE - offset, 1ULL << 30));
+            isOk = n > 0;
+            offset += isOk ? n : 0;
+        }
+        isOk = close(fd) == 0 && isOk;
+        if (!isOk || rename(tmpPath.c_str(), path.c_str()) != 0)
+        {
+            unlink(tmpPath.c_str());
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+// Remove pool files in directory except the ones of keepSeeds
+static void pruneRandom2PoolFiles(const std::string &directory, const m256i *keepSeeds, int numberOfKeepSeeds)
+{
+#ifdef __linux__
+    DIR *dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        std::string name = entry->d_name;
+        if (name.rfind("random2-", 0) != 0)
+        {
+            continue;
+        }
+        bool keep = false;
+        for (int i = 0; i < numberOfKeepSeeds; i++)
+        {
+            keep = keep || name == Random2Pool::fileName(keepSeeds[i]);
+        }
+        if (!keep)
+        {
+            unlink((directory + "/" + name).c_str());
+        }
+    }
+    closedir(dir);
+#endif
+}
+
+// Process-wide pool cache keyed by mining seed, double buffered.
+// A new pool is generated aside while the current one keeps serving, then becomes current and the
+// old current is kept as previous so solutions of the last seed still in flight do not trigger a rebuild.
+// Threads holding a pool keep it alive until they are done with it, even after it left the cache.
+// Only prepare() and prepareStray() build pools. Verification goes through acquire(), which never builds nor
+// evicts, so a solution carrying an unknown seed cannot stall the verify threads or push the live pool out.
+// Seeds other than the live ones (solutions queued before a restart, older seeds) get the stray slot, which
+// holds one pool at a time and never displaces current or previous.
+struct Random2PoolCache
+{
+private:
+    std::mutex mutex_;
+    std::condition_variable poolBuilt_;
+    std::shared_ptr<const Random2Pool> current_;
+    std::shared_ptr<const Random2Pool> previous_;
+    std::shared_ptr<const Random2Pool> stray_;
+    bool isBuilding_ = false;
+    bool isBuildingStray_ = false;
+    // Seeds registered by expect() whose pool is not built yet, acquire() waits for them
+    std::vector<m256i> expectedSeeds_;
+    std::string diskCacheDirectory_;
+
+    std::shared_ptr<const Random2Pool> find(const m256i &miningSeed)
+    {
+        if (current_ && current_->seed == miningSeed)
+        {
+            return current_;
+        }
+        if (previous_ && previous_->seed == miningSeed)
+        {
+            return previous_;
+        }
+        if (stray_ && stray_->seed == miningSeed)
+        {
+            return stray_;
+        }
+        return nullptr;
+    }
+
+    bool isExpected(const m256i &miningSeed)
+    {
+        for (const m256i &seed : expectedSeeds_)
+        {
+            if (seed == miningSeed)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void removeExpected(const m256i &miningSeed)
+    {
+        for (unsigned long long i = 0; i < expectedSeeds_.size(); i++)
+        {
+            if (expectedSeeds_[i] == miningSeed)
+            {
+                expectedSeeds_.erase(expectedSeeds_.begin() + i);
+                return;
+            }
+        }
+    }
+
+public:
+    // Optional, invoked from the building thread
+    Random2PoolProgressCallback onProgress;
+
+    // Announce that the pool of miningSeed is about to be built by prepare(), so solutions of that seed arriving
+    // before it is ready wait for it instead of being rejected. Return false when the seed is already cached or
+    // announced, there is then nothing to prepare.
+    bool expect(const m256i &miningSeed)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (find(miningSeed) || isExpected(miningSeed))
+        {
+            return false;
+        }
+        expectedSeeds_.push_back(miningSeed);
+        return true;
+    }
+
+    // Return the pool of miningSeed, generating it if neither slot holds it. The new pool becomes current.
+    // Concurrent callers wait for the pool being built instead of generating their own.
+    std::shared_ptr<const Random2Pool> prepare(const m256i &miningSeed)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            std::shared_ptr<const Random2Pool> pool = find(miningSeed);
+            if (pool)
+            {
+                removeExpected(miningSeed);
+                return pool;
+            }
+            if (!isBuilding_)
+            {
+                break;
+            }
+            poolBuilt_.wait(lock);
+        }
+        isBuilding_ = true;
+        lock.unlock();
+
+        const std::string directory = diskCacheDirectory_;
+        std::shared_ptr<Random2Pool> pool = std::make_shared<Random2Pool>(miningSeed);
+        const bool isLoaded = !directory.empty() && pool->load(directory);
+        bool isOk = isLoaded || pool->build(onProgress);
+        if (isLoaded && onProgress)
+        {
+            onProgress(*pool, 100);
+        }
+
+        lock.lock();
+        if (isOk)
+        {
+            previous_ = current_;
+            current_ = pool;
+        }
+        m256i keepSeeds[2] = {miningSeed, previous_ ? previous_->seed : miningSeed};
+        // Waiters of a failed build get nullptr rather than waiting forever
+        removeExpected(miningSeed);
+        isBuilding_ = false;
+        poolBuilt_.notify_all();
+        lock.unlock();
+
+        // Persist outside the lock, the pool is already being served
+        if (isOk && !isLoaded && !directory.empty())
+        {
+            pool->save(directory);
+            pruneRandom2PoolFiles(directory, keepSeeds, 2);
+        }
+        return isOk ? pool : nullptr;
+    }
+
+    // Build the pool of miningSeed into the stray slot, replacing the stray pool but leaving current and previous
+    // alone. The seed is not announced, its solutions keep coming back unprepared from acquire() until the pool is
+    // ready. Only one stray pool is built at a time, return nullptr if another one is being built or the build failed.
+    std::shared_ptr<const Random2Pool> prepareStray(const m256i &miningSeed)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::shared_ptr<const Random2Pool> cached = find(miningSeed);
+        if (cached || isBuildingStray_)
+        {
+            return cached;
+        }
+        isBuildingStray_ = true;
+        const std::string directory = diskCacheDirectory_;
+        lock.unlock();
+
+        std::shared_ptr<Random2Pool> pool = std::make_shared<Random2Pool>(miningSeed);
+        const bool isLoaded = !directory.empty() && pool->load(directory);
+        const bool isOk = isLoaded || pool->build(onProgress);
+        if (isLoaded && onProgress)
+        {
+            onProgress(*pool, 100);
+        }
+
+        lock.lock();
+        if (isOk)
+        {
+            stray_ = pool;
+        }
+        isBuildingStray_ = false;
+        return isOk ? pool : nullptr;
+    }
+
+    // Return the pool of miningSeed if it is cached, waiting for it while it is announced or being built.
+    // Any other seed returns nullptr right away.
+    std::shared_ptr<const Random2Pool> acquire(const m256i &miningSeed)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            std::shared_ptr<const Random2Pool> pool = find(miningSeed);
+            if (pool || !isExpected(miningSeed))
+            {
+                return pool;
+            }
+            poolBuilt_.wait(lock);
+        }
+    }
+
+    // Enable the on-disk cache: generated pools are saved to directory and mapped back from there
+    // on the next start, so restarted or co-located verifiers share them through the page cache
+    void setDiskCacheDirectory(const std::string &directory)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        diskCacheDirectory_ = directory;
+    }
+
+    // Check without building
+    bool contains(const m256i &miningSeed)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return find(miningSeed) != nullptr;
+    }
+
+    std::shared_ptr<const Random2Pool> current()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return current_;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        current_.reset();
+        previous_.reset();
+        stray_.reset();
+    }
+};
@@ -1,16 +1,23 @@
 ﻿#pragma once
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include "overload.hpp"
 #ifdef NO_UEFI
 static unsigned long long top_of_stack;
 #endif
 #include "m256.hpp"
+#include "memory.hpp"
 #include "public_settings.hpp"
 #include "mining/score_engine.hpp"
+#if USE_SCORE_CACHE
+#include "score_cache.hpp"
+#endif
 
 template <unsigned long long solutionBufferCount>
 struct ScoreFunction
 {
-    score_engine::ScoreEngine<
+    typedef score_engine::ScoreEngine<
         score_engine::HyperIdentityParams<
             HYPERIDENTITY_NUMBER_OF_INPUT_NEURONS,
             HYPERIDENTITY_NUMBER_OF_OUTPUT_NEURONS,
@@ -28,40 +35,41 @@ struct ScoreFunction
             ADDITION_POPULATION_THRESHOLD,
             ADDITION_NUMBER_OF_MUTATIONS,
             ADDITION_SOLUTION_THRESHOLD_DEFAULT>>
-        _computeBuffer[solutionBufferCount];
+        ScoreEngineType;
 
-    volatile char random2PoolLock;
-    unsigned char state[score_engine::STATE_SIZE];
-    unsigned char externalPoolVec[score_engine::POOL_VEC_PADDING_SIZE];
-    unsigned char poolVec[score_engine::POOL_VEC_PADDING_SIZE];
+    // One compute buffer (~17MB) per concurrent scorer. A buffer is only allocated, on huge pages when possible,
+    // by the first thread that claims its slot, so a large solutionBufferCount only costs memory for the slots
+    // actually used and the pages land on that thread's NUMA node.
+    ScoreEngineType *_computeBuffer[solutionBufferCount];
+    unsigned long long _computeBufferPageSize[solutionBufferCount];
 
-    void initPool(const unsigned char *miningSeed)
-    {
-        // Init random2 pool with mining seed
-        score_engine::generateRandom2Pool(miningSeed, state, externalPoolVec);
-    }
+    volatile char random2PoolLock;
+    // Random2 pool of currentRandomSeed, owned by the caller and shared between ScoreFunction instances.
+    // It must stay alive as long as it is set here.
+    const unsigned char *poolVec;
 
     m256i currentRandomSeed;
 
+    // One lock per compute buffer, see acquireComputeBuffer / releaseComputeBuffer.
+    // Callers that find every slot taken sleep on computeBufferReleased instead of spinning.
     volatile char solutionEngineLock[solutionBufferCount];
+    std::mutex computeBufferMutex;
+    std::condition_variable computeBufferReleased;
+    // Callers sleeping on computeBufferReleased, releases only take computeBufferMutex while there are any
+    std::atomic<unsigned int> computeBufferWaiters{0};
 
 #if USE_SCORE_CACHE
-    volatile char scoreCacheLock;
-    ScoreCache<SCORE_CACHE_SIZE, SCORE_CACHE_COLLISION_RETRIES> scoreCache;
+    // Shared by every ScoreFunction of the process so all verify threads hit the same cache
+    static inline volatile char scoreCacheLock = 0;
+    static inline ScoreCache<SCORE_CACHE_SIZE, SCORE_CACHE_COLLISION_RETRIES> scoreCache;
 #endif
 
-    void initMiningData(m256i randomSeed)
+    // Point the scorer at a pool already generated for randomSeed (see score_engine::generateRandom2Pool)
+    void initMiningData(m256i randomSeed, const unsigned char *pool)
     {
-        // Below assume when a new mining seed is provided, we need to re-calculate the random2 pool
-        // Check if random pool need to be re-generated
-        if (!isZero(randomSeed))
-        {
-            initPool(randomSeed.m256i_u8);
-        }
-        currentRandomSeed = randomSeed; // persist the initial random seed to be able to send it back on system info response
-
         ACQUIRE(random2PoolLock);
-        copyMem(poolVec, externalPoolVec, score_engine::POOL_VEC_PADDING_SIZE);
+        currentRandomSeed = randomSeed; // persist the initial random seed to be able to send it back on system info response
+        poolVec = pool;
         RELEASE(random2PoolLock);
     }
 
@@ -72,55 +80,57 @@ struct ScoreFunction
 
     void freeMemory()
     {
+        for (unsigned long long i = 0; i < solutionBufferCount; i++)
+        {
+            if (_computeBuffer[i])
+            {
+                freeLargePages(_computeBuffer[i], sizeof(ScoreEngineType), _computeBufferPageSize[i]);
+                _computeBuffer[i] = nullptr;
+            }
+        }
     }
 
     bool initMemory()
     {
         random2PoolLock = 0;
+        poolVec = nullptr;
+        setMem(&currentRandomSeed, sizeof(currentRandomSeed), 0);
 
-        // Make sure all padding data is set as zeros
-        setMem(_computeBuffer, sizeof(_computeBuffer), 0);
-        for (int i = 0; i < solutionBufferCount; i++)
-        {
-            _computeBuffer[i].initMemory();
-        }
-
-        for (int i = 0; i < solutionBufferCount; i++)
+        for (unsigned long long i = 0; i < solutionBufferCount; i++)
         {
             solutionEngineLock[i] = 0;
+            _computeBuffer[i] = nullptr;
+            _computeBufferPageSize[i] = 0;
         }
 
-#if USE_SCORE_CACHE
-        scoreCacheLock = 0;
-        setMem(&scoreCache, sizeof(scoreCache), 0);
-#endif
-
         return true;
     }
 
-    // Save score cache to SCORE_CACHE_FILE_NAME
-    void saveScoreCache(int epoch, CHAR16 *directory = NULL)
+    // Save score cache to score.<epoch> and drop the files of older epochs, their seeds never come back
+    static bool saveScoreCache(int epoch, const char *directory = NULL)
     {
+        bool success = true;
 #if USE_SCORE_CACHE
+        const std::string fileName = scoreCacheFileName(epoch);
         ACQUIRE(scoreCacheLock);
-        SCORE_CACHE_FILE_NAME[sizeof(SCORE_CACHE_FILE_NAME) / sizeof(SCORE_CACHE_FILE_NAME[0]) - 4] = epoch / 100 + L'0';
-        SCORE_CACHE_FILE_NAME[sizeof(SCORE_CACHE_FILE_NAME) / sizeof(SCORE_CACHE_FILE_NAME[0]) - 3] = (epoch % 100) / 10 + L'0';
-        SCORE_CACHE_FILE_NAME[sizeof(SCORE_CACHE_FILE_NAME) / sizeof(SCORE_CACHE_FILE_NAME[0]) - 2] = epoch % 10 + L'0';
-        scoreCache.save(SCORE_CACHE_FILE_NAME, directory);
+        success = scoreCache.save(fileName.c_str(), directory);
+        if (success)
+        {
+            pruneScoreCacheFiles(directory, epoch);
+        }
         RELEASE(scoreCacheLock);
 #endif
+        return success;
     }
 
-    // Update score cache filename with epoch and try to load file
-    bool loadScoreCache(int epoch)
+    // Try to load the score cache file of epoch
+    static bool loadScoreCache(int epoch, const char *directory = NULL)
     {
         bool success = true;
 #if USE_SCORE_CACHE
+        const std::string fileName = scoreCacheFileName(epoch);
         ACQUIRE(scoreCacheLock);
-        SCORE_CACHE_FILE_NAME[sizeof(SCORE_CACHE_FILE_NAME) / sizeof(SCORE_CACHE_FILE_NAME[0]) - 4] = epoch / 100 + L'0';
-        SCORE_CACHE_FILE_NAME[sizeof(SCORE_CACHE_FILE_NAME) / sizeof(SCORE_CACHE_FILE_NAME[0]) - 3] = (epoch % 100) / 10 + L'0';
-        SCORE_CACHE_FILE_NAME[sizeof(SCORE_CACHE_FILE_NAME) / sizeof(SCORE_CACHE_FILE_NAME[0]) - 2] = epoch % 10 + L'0';
-        success = scoreCache.load(SCORE_CACHE_FILE_NAME);
+        success = scoreCache.load(fileName.c_str(), directory);
         RELEASE(scoreCacheLock);
 #endif
         return success;
@@ -143,26 +153,122 @@ struct ScoreFunction
         return checkAlgoThreshold(threshold, selectedAlgo) && (solutionScore >= (unsigned int)threshold);
     }
 
-    unsigned int computeScore(const unsigned long long solutionBufIdx, const m256i &publicKey, const m256i &nonce)
+    unsigned int computeScore(const unsigned long long solutionBufIdx, const m256i &publicKey, const m256i &nonce, const unsigned char *pool, unsigned int scoreThreshold = 0, unsigned int numberOfSampleThreads = 1)
     {
-        return _computeBuffer[solutionBufIdx].computeScore(publicKey.m256i_u8, nonce.m256i_u8, poolVec);
+        _computeBuffer[solutionBufIdx]->setNumberOfSampleThreads(numberOfSampleThreads);
+        return _computeBuffer[solutionBufIdx]->computeScore(publicKey.m256i_u8, nonce.m256i_u8, pool, scoreThreshold);
     }
 
-    m256i getLastOutput(const unsigned long long processor_Number)
+    // Claim a free compute buffer and return its index, or solutionBufferCount when its memory cannot be allocated.
+    // The search starts at the caller's own slot, so with no more callers than slots nobody ever waits.
+    // Release it with releaseComputeBuffer.
+    unsigned long long acquireComputeBuffer(const unsigned long long processor_Number)
     {
-        ACQUIRE(solutionEngineLock[processor_Number]);
+        const unsigned long long firstBufIdx = processor_Number % solutionBufferCount;
+        unsigned long long solutionBufIdx = firstBufIdx;
+        while (!TRY_ACQUIRE(solutionEngineLock[solutionBufIdx]))
+        {
+            solutionBufIdx = (solutionBufIdx + 1) % solutionBufferCount;
+            if (solutionBufIdx == firstBufIdx)
+            {
+                // Every slot is busy. Register as waiter, then scan again under the mutex: a release either
+                // shows up in the scan or sees the waiter and notifies once the wait started.
+                std::unique_lock<std::mutex> lock(computeBufferMutex);
+                computeBufferWaiters.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                while (!TRY_ACQUIRE(solutionEngineLock[solutionBufIdx]))
+                {
+                    solutionBufIdx = (solutionBufIdx + 1) % solutionBufferCount;
+                    if (solutionBufIdx == firstBufIdx)
+                    {
+                        computeBufferReleased.wait(lock);
+                    }
+                }
+                computeBufferWaiters.fetch_sub(1);
+                break;
+            }
+        }
 
-        m256i result = _computeBuffer[processor_Number].getLastOutput();
+        if (!_computeBuffer[solutionBufIdx])
+        {
+            ScoreEngineType *buffer = nullptr;
+            if (!allocateLargePages(sizeof(ScoreEngineType), (void **)&buffer, &_computeBufferPageSize[solutionBufIdx]))
+            {
+                releaseComputeBuffer(solutionBufIdx);
+                return solutionBufferCount;
+            }
+            buffer->initMemory();
+            _computeBuffer[solutionBufIdx] = buffer;
+        }
+        return solutionBufIdx;
+    }
 
-        RELEASE(solutionEngineLock[processor_Number]);
-        return result;
+    void releaseComputeBuffer(const unsigned long long solutionBufIdx)
+    {
+        RELEASE(solutionEngineLock[solutionBufIdx]);
+        // Pairs with the fence of a waiter in acquireComputeBuffer
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (computeBufferWaiters.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(computeBufferMutex);
+            computeBufferReleased.notify_one();
+        }
+    }
+
+    // Whether acquireComputeBuffer returned a buffer, it returns solutionBufferCount when the allocation failed
+    static bool isValidComputeBuffer(const unsigned long long solutionBufIdx)
+    {
+        return solutionBufIdx < solutionBufferCount;
     }
-    // main score function
-    unsigned int operator()(const unsigned long long processor_Number, const m256i &publicKey, const m256i &miningSeed, const m256i &nonce)
+
+    // Page size backing an allocated compute buffer
+    unsigned long long getComputeBufferPageSize(const unsigned long long solutionBufIdx)
+    {
+        return _computeBufferPageSize[solutionBufIdx];
+    }
+
+    // Output of the last score computed in a compute buffer the caller holds, like computeScore
+    m256i getLastOutput(const unsigned long long solutionBufIdx)
+    {
+        return _computeBuffer[solutionBufIdx]->getLastOutput();
+    }
+    // main score function, scores against the pool set by initMiningData
+    unsigned int operator()(const unsigned long long processor_Number, const m256i &publicKey, const m256i &miningSeed, const m256i &nonce, unsigned int scoreThreshold = 0, bool *isLowerBound = nullptr)
+    {
+        if (isLowerBound)
+        {
+            *isLowerBound = false;
+        }
+
+        ACQUIRE(random2PoolLock);
+        // memcmp rather than ==, m256i is only 8-byte aligned and == may use aligned loads
+        const bool isCurrentSeed = memcmp(miningSeed.m256i_u8, currentRandomSeed.m256i_u8, 32) == 0;
+        const unsigned char *pool = poolVec;
+        RELEASE(random2PoolLock);
+
+        if (!isCurrentSeed)
+        {
+            return score_engine::INVALID_SCORE_VALUE;
+        }
+        return (*this)(processor_Number, publicKey, miningSeed, nonce, pool, scoreThreshold, 1, nullptr, isLowerBound);
+    }
+
+    // Score against the random2 pool of miningSeed owned by the caller, threads working on different seeds can share
+    // one ScoreFunction this way. numberOfSampleThreads > 1 lets a single score use extra idle threads.
+    // lastOutput, when set, receives getLastOutput() of the computed score, it is left untouched on a score cache hit.
+    // scoreThreshold = 0 scores exactly. Otherwise scoring may stop once the solution reaches scoreThreshold and report
+    // that lower bound, enough for callers that only compare the score against thresholds up to this one.
+    // isLowerBound, when set, tells whether the score stopped at scoreThreshold and is not the exact one.
+    unsigned int operator()(const unsigned long long processor_Number, const m256i &publicKey, const m256i &miningSeed, const m256i &nonce, const unsigned char *pool, unsigned int scoreThreshold = 0, unsigned int numberOfSampleThreads = 1, m256i *lastOutput = nullptr, bool *isLowerBound = nullptr)
     {
         PROFILE_SCOPE();
 
-        if (isZero(miningSeed) || miningSeed != currentRandomSeed)
+        if (isLowerBound)
+        {
+            *isLowerBound = false;
+        }
+
+        if (isZero(miningSeed) || !pool)
         {
             return score_engine::INVALID_SCORE_VALUE;
         }
@@ -178,14 +284,30 @@ struct ScoreFunction
         score = 0;
 #endif
 
-        const int solutionBufIdx = (int)(processor_Number % solutionBufferCount);
-        ACQUIRE(solutionEngineLock[solutionBufIdx]);
+        const unsigned long long solutionBufIdx = acquireComputeBuffer(processor_Number);
+        if (!isValidComputeBuffer(solutionBufIdx))
+        {
+            return score_engine::INVALID_SCORE_VALUE;
+        }
 
-        score = computeScore(solutionBufIdx, publicKey, nonce);
+        score = computeScore(solutionBufIdx, publicKey, nonce, pool, scoreThreshold, numberOfSampleThreads);
+        if (lastOutput)
+        {
+            *lastOutput = getLastOutput(solutionBufIdx);
+        }
+        const bool isScoreLowerBound = _computeBuffer[solutionBufIdx]->lastScoreIsLowerBound;
+        if (isLowerBound)
+        {
+            *isLowerBound = isScoreLowerBound;
+        }
 
-        RELEASE(solutionEngineLock[solutionBufIdx]);
+        releaseComputeBuffer(solutionBufIdx);
 #if USE_SCORE_CACHE
-        scoreCache.addEntry(publicKey, miningSeed, nonce, scoreCacheIndex, score);
+        // Only cache exact scores, the cache is also persisted by saveScoreCache
+        if (!isScoreLowerBound)
+        {
+            scoreCache.addEntry(publicKey, miningSeed, nonce, scoreCacheIndex, score);
+        }
 #endif
 #ifdef NO_UEFI
         int y = 2 + score;
@@ -208,6 +330,9 @@ struct ScoreFunction
         m256i publicKey[NUMBER_OF_TRANSACTIONS_PER_TICK];
         m256i miningSeed[NUMBER_OF_TRANSACTIONS_PER_TICK];
         m256i nonce[NUMBER_OF_TRANSACTIONS_PER_TICK];
+        unsigned int scoreThreshold[NUMBER_OF_TRANSACTIONS_PER_TICK];
+        unsigned int score[NUMBER_OF_TRANSACTIONS_PER_TICK]; // Filled by tryProcessSolution, in addTask order
+        bool isScoreLowerBound[NUMBER_OF_TRANSACTIONS_PER_TICK];
     } taskQueue;
     unsigned int _nTask;
     unsigned int _nProcessing;
@@ -225,9 +350,11 @@ struct ScoreFunction
     }
 
     // add task to the queue
-    // queue size is limited at NUMBER_OF_TRANSACTIONS_PER_TICK
-    void addTask(m256i publicKey, m256i miningSeed, m256i nonce)
+    // queue size is limited at NUMBER_OF_TRANSACTIONS_PER_TICK, return false when the task does not fit
+    // scoreThreshold is the early exit threshold of this task, see operator()
+    bool addTask(m256i publicKey, m256i miningSeed, m256i nonce, unsigned int scoreThreshold = 0)
     {
+        bool result = false;
         ACQUIRE(taskQueueLock);
         if (_nTask < NUMBER_OF_TRANSACTIONS_PER_TICK)
         {
@@ -235,8 +362,13 @@ struct ScoreFunction
             taskQueue.publicKey[index] = publicKey;
             taskQueue.miningSeed[index] = miningSeed;
             taskQueue.nonce[index] = nonce;
+            taskQueue.scoreThreshold[index] = scoreThreshold;
+            taskQueue.score[index] = score_engine::INVALID_SCORE_VALUE;
+            taskQueue.isScoreLowerBound[index] = false;
+            result = true;
         }
         RELEASE(taskQueueLock);
+        return result;
     }
 
     void startProcessTaskQueue()
@@ -254,7 +386,7 @@ struct ScoreFunction
     }
 
     // get a task, can call on any thread
-    bool getTask(m256i *publicKey, m256i *miningSeed, m256i *nonce)
+    bool getTask(m256i *publicKey, m256i *miningSeed, m256i *nonce, unsigned int *taskIndex)
     {
         if (!_nIsTaskQueueReady)
         {
@@ -265,6 +397,7 @@ struct ScoreFunction
         if (_nProcessing < _nTask)
         {
             unsigned int index = _nProcessing++;
+            *taskIndex = index;
             *publicKey = taskQueue.publicKey[index];
             *miningSeed = taskQueue.miningSeed[index];
             *nonce = taskQueue.nonce[index];
@@ -289,16 +422,36 @@ struct ScoreFunction
         return _nFinished == _nTask;
     }
 
-    void tryProcessSolution(unsigned long long processorNumber)
+    unsigned int getNumberOfTasks()
+    {
+        return _nTask;
+    }
+
+    // Score of a task once isTaskQueueProcessed(), INVALID_SCORE_VALUE for tasks that were not processed
+    unsigned int getTaskScore(unsigned int taskIndex)
+    {
+        return taskQueue.score[taskIndex];
+    }
+
+    // Whether the score of a task stopped at its scoreThreshold, see operator()
+    bool isTaskScoreLowerBound(unsigned int taskIndex)
+    {
+        return taskQueue.isScoreLowerBound[taskIndex];
+    }
+
+    // Process one task, return false when there is no task left to take
+    bool tryProcessSolution(unsigned long long processorNumber)
     {
         m256i publicKey;
         m256i miningSeed;
         m256i nonce;
-        bool res = this->getTask(&publicKey, &miningSeed, &nonce);
+        unsigned int taskIndex;
+        bool res = this->getTask(&publicKey, &miningSeed, &nonce, &taskIndex);
         if (res)
         {
-            (*this)(processorNumber, publicKey, miningSeed, nonce);
+            taskQueue.score[taskIndex] = (*this)(processorNumber, publicKey, miningSeed, nonce, taskQueue.scoreThreshold[taskIndex], &taskQueue.isScoreLowerBound[taskIndex]);
             this->finishTask();
         }
+        return res;
     }
 };
\ No newline at end of file
@@ -0,0 +1,282 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#ifdef __linux__
+#include <dirent.h>
+#include <unistd.h>
+#endif
+#include "m256.hpp"
+#include "keyUtils.hpp"
+
+#define SCORE_CACHE_FILE_MAGIC "QSCORECH"
+#define SCORE_CACHE_FILE_VERSION 1
+
+struct ScoreCacheFileHeader
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int entrySize;
+    unsigned long long cacheSize;
+    unsigned long long collisionRetries;
+};
+
+// score.<epoch>, the epoch padded to 3 digits
+static std::string scoreCacheFileName(int epoch)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "score.%03d", epoch);
+    return name;
+}
+
+// Fixed-size (publicKey, miningSeed, nonce) -> score cache shared by all verify threads.
+// Entries are grouped in buckets of collisionRetries slots, a key only ever lives in the bucket picked by
+// getCacheIndex(). Buckets are split into lock stripes, so threads only contend when they hit the same stripe.
+template <unsigned long long scoreCacheSize, unsigned long long collisionRetries>
+struct ScoreCache
+{
+    static_assert(collisionRetries > 0 && scoreCacheSize % collisionRetries == 0, "scoreCacheSize must be a multiple of collisionRetries");
+
+    static constexpr unsigned long long numberOfBuckets = scoreCacheSize / collisionRetries;
+    static constexpr unsigned long long numberOfStripes = numberOfBuckets < 256 ? numberOfBuckets : 256;
+    static constexpr unsigned long long bucketsPerStripe = (numberOfBuckets + numberOfStripes - 1) / numberOfStripes;
+
+    // Any lookup result below this is a miss
+    static constexpr int MIN_VALID_SCORE = 0;
+
+    struct alignas(32) ScoreCacheEntry
+    {
+        m256i publicKey;
+        m256i miningSeed; // zero marks a free slot, a zero seed is never scored
+        m256i nonce;
+        int score;
+    };
+
+private:
+    ScoreCacheEntry cache[scoreCacheSize];
+    std::mutex stripeLocks[numberOfStripes];
+
+    std::mutex &stripeLockOf(unsigned int bucketIndex)
+    {
+        return stripeLocks[bucketIndex / bucketsPerStripe];
+    }
+
+    // Keys come from callers' stacks where m256i is only 8-byte aligned, so compare with unaligned loads
+    static bool isEqualKey(const m256i &a, const m256i &b)
+    {
+        __m256i diff = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)&a), _mm256_loadu_si256((const __m256i *)&b));
+        return _mm256_testz_si256(diff, diff) == 1;
+    }
+
+    static bool isMatching(const ScoreCacheEntry &entry, const m256i &publicKey, const m256i &miningSeed, const m256i &nonce)
+    {
+        return isEqualKey(entry.miningSeed, miningSeed) && isEqualKey(entry.nonce, nonce) && isEqualKey(entry.publicKey, publicKey);
+    }
+
+public:
+    std::atomic<unsigned long long> hits{0};
+    std::atomic<unsigned long long> misses{0};
+    std::atomic<unsigned long long> evictions{0};
+
+    unsigned int getCacheIndex(const m256i &publicKey, const m256i &miningSeed, const m256i &nonce)
+    {
+        // Nonces are picked by miners, hash the whole key so nobody can aim at a single bucket
+        m256i buffer[3] = {publicKey, miningSeed, nonce};
+        unsigned long long digest;
+        KangarooTwelve((const unsigned char *)buffer, sizeof(buffer), (unsigned char *)&digest, sizeof(digest));
+        return (unsigned int)(digest % numberOfBuckets);
+    }
+
+    // Return the cached score, or a value below MIN_VALID_SCORE when the key is not cached
+    int tryFetching(const m256i &publicKey, const m256i &miningSeed, const m256i &nonce, unsigned int cacheIndex)
+    {
+        {
+            std::lock_guard<std::mutex> lock(stripeLockOf(cacheIndex));
+            const ScoreCacheEntry *bucket = &cache[cacheIndex * collisionRetries];
+            for (unsigned long long i = 0; i < collisionRetries; i++)
+            {
+                if (isZero(bucket[i].miningSeed))
+                {
+                    break;
+                }
+                if (isMatching(bucket[i], publicKey, miningSeed, nonce))
+                {
+                    hits.fetch_add(1, std::memory_order_relaxed);
+                    return bucket[i].score;
+                }
+            }
+        }
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return MIN_VALID_SCORE - 1;
+    }
+
+    // Insert at the front of the bucket, the oldest entry falls off when the bucket is full
+    void addEntry(const m256i &publicKey, const m256i &miningSeed, const m256i &nonce, unsigned int cacheIndex, int score)
+    {
+        if (score < MIN_VALID_SCORE || isEqualKey(miningSeed, m256i::zero()))
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(stripeLockOf(cacheIndex));
+        ScoreCacheEntry *bucket = &cache[cacheIndex * collisionRetries];
+        unsigned long long last = collisionRetries - 1;
+        for (unsigned long long i = 0; i < collisionRetries; i++)
+        {
+            if (isZero(bucket[i].miningSeed))
+            {
+                last = i;
+                break;
+            }
+            if (isMatching(bucket[i], publicKey, miningSeed, nonce))
+            {
+                // Another thread scored the same solution meanwhile
+                return;
+            }
+        }
+        if (last == collisionRetries - 1 && !isZero(bucket[last].miningSeed))
+        {
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::copy_backward(&bucket[0], &bucket[last], &bucket[last + 1]);
+        bucket[0].publicKey = publicKey;
+        bucket[0].miningSeed = miningSeed;
+        bucket[0].nonce = nonce;
+        bucket[0].score = score;
+    }
+
+    void clear()
+    {
+        for (unsigned long long stripe = 0; stripe < numberOfStripes; stripe++)
+        {
+            std::lock_guard<std::mutex> lock(stripeLocks[stripe]);
+            unsigned long long begin = stripe * bucketsPerStripe * collisionRetries;
+            unsigned long long end = std::min(begin + bucketsPerStripe * collisionRetries, scoreCacheSize);
+            if (begin < end)
+            {
+                std::fill(&cache[begin], &cache[end], ScoreCacheEntry{});
+            }
+        }
+        hits = 0;
+        misses = 0;
+        evictions = 0;
+    }
+
+    static std::string filePath(const char *fileName, const char *directory)
+    {
+        if (directory == NULL || directory[0] == '\0')
+        {
+            return fileName;
+        }
+        return std::string(directory) + "/" + fileName;
+    }
+
+    // Dump the whole table one stripe at a time, verification keeps going on the other stripes meanwhile
+    bool save(const char *fileName, const char *directory = NULL)
+    {
+        std::string path = filePath(fileName, directory);
+        std::string tmpPath = path + ".tmp";
+        FILE *file = fopen(tmpPath.c_str(), "wb");
+        if (!file)
+        {
+            return false;
+        }
+
+        ScoreCacheFileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, SCORE_CACHE_FILE_MAGIC, sizeof(header.magic));
+        header.version = SCORE_CACHE_FILE_VERSION;
+        header.entrySize = sizeof(ScoreCacheEntry);
+        header.cacheSize = scoreCacheSize;
+        header.collisionRetries = collisionRetries;
+        bool isOk = fwrite(&header, sizeof(header), 1, file) == 1;
+
+        for (unsigned long long stripe = 0; isOk && stripe < numberOfStripes; stripe++)
+        {
+            std::lock_guard<std::mutex> lock(stripeLocks[stripe]);
+            unsigned long long begin = stripe * bucketsPerStripe * collisionRetries;
+            unsigned long long end = std::min(begin + bucketsPerStripe * collisionRetries, scoreCacheSize);
+            if (begin < end)
+            {
+                isOk = fwrite(&cache[begin], sizeof(ScoreCacheEntry), end - begin, file) == end - begin;
+            }
+        }
+
+        isOk = (fclose(file) == 0) && isOk;
+        if (!isOk || rename(tmpPath.c_str(), path.c_str()) != 0)
+        {
+            remove(tmpPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Replace the table with a saved one, a missing or mismatching file leaves the cache untouched
+    bool load(const char *fileName, const char *directory = NULL)
+    {
+        std::string path = filePath(fileName, directory);
+        FILE *file = fopen(path.c_str(), "rb");
+        if (!file)
+        {
+            return false;
+        }
+
+        ScoreCacheFileHeader header;
+        if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, SCORE_CACHE_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != SCORE_CACHE_FILE_VERSION || header.entrySize != sizeof(ScoreCacheEntry) || header.cacheSize != scoreCacheSize || header.collisionRetries != collisionRetries)
+        {
+            fclose(file);
+            return false;
+        }
+
+        bool isOk = true;
+        for (unsigned long long stripe = 0; isOk && stripe < numberOfStripes; stripe++)
+        {
+            std::lock_guard<std::mutex> lock(stripeLocks[stripe]);
+            unsigned long long begin = stripe * bucketsPerStripe * collisionRetries;
+            unsigned long long end = std::min(begin + bucketsPerStripe * collisionRetries, scoreCacheSize);
+            if (begin < end)
+            {
+                isOk = fread(&cache[begin], sizeof(ScoreCacheEntry), end - begin, file) == end - begin;
+            }
+        }
+        fclose(file);
+
+        if (!isOk)
+        {
+            // Truncated file, do not keep a half loaded table
+            clear();
+        }
+        return isOk;
+    }
+};
+
+// Remove the score cache files of other epochs than keepEpoch from directory
+static void pruneScoreCacheFiles(const char *directory, int keepEpoch)
+{
+#ifdef __linux__
+    std::string path = (directory == NULL || directory[0] == '\0') ? "." : directory;
+    DIR *dir = opendir(path.c_str());
+    if (!dir)
+    {
+        return;
+    }
+    const std::string keepName = scoreCacheFileName(keepEpoch);
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        std::string name = entry->d_name;
+        if (name.size() != keepName.size() || name.rfind("score.", 0) != 0 || name.find_first_not_of("0123456789", 6) != std::string::npos)
+        {
+            continue;
+        }
+        if (name != keepName)
+        {
+            unlink((path + "/" + name).c_str());
+        }
+    }
+    closedir(dir);
+#endif
+}
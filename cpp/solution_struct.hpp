@@ -2,72 +2,230 @@
 #include <iostream>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <cstring>
 #include <string>
 
 using namespace std;
+// Binary layout shared with JS (see NodeManager.pushSolutionsToVerifyQueue), one record per solution
 struct Solution
 {
-    char miningSeed[64];
-    char nonce[64];
-    char computorId[60];
-    string md5Hash;
-
-    Solution(const char *miningSeed, const char *nonce, const char *computorId, string md5Hash)
-    {
-        memcpy(this->miningSeed, miningSeed, 64);
-        memcpy(this->nonce, nonce, 64);
-        memcpy(this->computorId, computorId, 60);
-
-        this->md5Hash = md5Hash;
-    }
+    unsigned char miningSeed[32];
+    unsigned char nonce[32];
+    unsigned char computorPublicKey[32];
+    unsigned char md5Hash[16];
+    // Early exit threshold of this solution, 0 scores exactly (see ScoreFunction::operator())
+    unsigned int scoreThreshold;
 };
+static_assert(sizeof(Solution) == 116, "Solution must match the JS record layout");
 
+// Bounded FIFO between the JS thread (producer) and the verify threads (consumers).
+// Consumers block in pop() until a solution arrives or the queue is closed. Closing only releases the
+// consumers: queued solutions stay and are handed out again once the queue is reopened.
 struct SolutionQueue
 {
 private:
     std::mutex mutex_;
+    std::condition_variable notEmpty_;
     vector<Solution> solutions;
+    unsigned long long head_ = 0;
+    unsigned long long count_ = 0;
+    bool isClosed_ = false;
 
 public:
-    void addSolution(Solution solution)
+    SolutionQueue(unsigned long long capacity = 16384) : solutions(capacity) {}
+
+    // Return false when the queue is full
+    bool push(const Solution &solution)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        solutions.push_back(solution);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (count_ == solutions.size())
+            {
+                return false;
+            }
+            solutions[(head_ + count_) % solutions.size()] = solution;
+            count_++;
+        }
+        notEmpty_.notify_one();
+        return true;
     }
 
-    Solution getSolution()
+    // Push as many of the count solutions as fit, return how many were queued
+    unsigned long long push(const Solution *batch, unsigned long long count)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        Solution solution = solutions.back();
-        solutions.pop_back();
-        return solution;
+        unsigned long long pushed = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (pushed < count && count_ < solutions.size())
+            {
+                solutions[(head_ + count_) % solutions.size()] = batch[pushed++];
+                count_++;
+            }
+        }
+        if (pushed > 1)
+        {
+            notEmpty_.notify_all();
+        }
+        else if (pushed == 1)
+        {
+            notEmpty_.notify_one();
+        }
+        return pushed;
+    }
+
+    // Wait for the oldest solution, return false when the queue got closed
+    bool pop(Solution &solution)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this]
+                       { return isClosed_ || count_ > 0; });
+        if (isClosed_)
+        {
+            return false;
+        }
+        solution = solutions[head_];
+        head_ = (head_ + 1) % solutions.size();
+        count_--;
+        return true;
+    }
+
+    // Wake up every consumer and make pop() fail until open() is called, even while solutions are still queued.
+    // There is no drain: queued solutions stay for the consumers started after open().
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            isClosed_ = true;
+        }
+        notEmpty_.notify_all();
     }
 
-    bool hasSolution()
+    void open()
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        return !solutions.empty();
+        isClosed_ = false;
     }
 
     void clear()
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        solutions.clear();
+        head_ = 0;
+        count_ = 0;
     }
 
     int size()
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        return solutions.size();
+        return count_;
     }
 
     void print()
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        for (auto &solution : solutions)
+        for (unsigned long long i = 0; i < count_; i++)
+        {
+            Solution &solution = solutions[(head_ + i) % solutions.size()];
+            cout << "Solution: ";
+            for (int j = 0; j < 16; j++)
+            {
+                printf("%02x", solution.md5Hash[j]);
+            }
+            cout << endl;
+        }
+    }
+};
+
+struct SolutionResult
+{
+    // Raw bytes, the dispatcher turns the hashes of a whole batch into hex at once
+    unsigned char md5Hash[16];
+    unsigned int resultScore;
+    int algo;
+    // resultScore stopped at the early exit threshold, it is only a lower bound of the exact score
+    bool isScoreLowerBound;
+    // The random2 pool of its seed is not prepared, the solution was not scored and has to be queued again
+    bool isSeedUnprepared;
+};
+
+// Verified results waiting to be delivered to JS. Verify threads only append; a single dispatcher takes
+// everything pending as one batch once enough results piled up or the oldest one waited long enough.
+struct SolutionResultBuffer
+{
+private:
+    std::mutex mutex_;
+    std::condition_variable batchReady_;
+    vector<SolutionResult> results;
+    std::chrono::steady_clock::time_point oldest_;
+    bool isClosed_ = false;
+
+public:
+    unsigned long long flushSize = 64;
+    std::chrono::milliseconds maxDelay = std::chrono::milliseconds(50);
+
+    void push(SolutionResult result)
+    {
+        bool isFull;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (results.empty())
+            {
+                oldest_ = std::chrono::steady_clock::now();
+            }
+            results.push_back(std::move(result));
+            isFull = results.size() >= flushSize;
+        }
+        if (isFull)
         {
-            cout << "Solution: " << solution.miningSeed << " " << solution.nonce << " " << solution.computorId << endl;
+            batchReady_.notify_one();
         }
     }
+
+    // Wait for the next batch, return false once the buffer is closed and fully drained
+    bool pop(vector<SolutionResult> &batch)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            if (results.size() >= flushSize || (isClosed_ && !results.empty()))
+            {
+                break;
+            }
+            if (isClosed_)
+            {
+                return false;
+            }
+            if (results.empty())
+            {
+                batchReady_.wait_for(lock, maxDelay);
+                continue;
+            }
+            std::chrono::steady_clock::time_point deadline = oldest_ + maxDelay;
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                break;
+            }
+            batchReady_.wait_until(lock, deadline);
+        }
+        batch.clear();
+        batch.swap(results);
+        return true;
+    }
+
+    // Let the dispatcher flush what is left and stop
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            isClosed_ = true;
+        }
+        batchReady_.notify_all();
+    }
+
+    void open()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isClosed_ = false;
+    }
 };
@@ -0,0 +1,101 @@
+// Golden vector generator for the conformance runner. It scores with the baseline scorer (the tree as of
+// commit 40ddf45, before any of the verification optimizations), so cpp/score_vectors.txt holds values the
+// code under test did not produce itself. It therefore has to be built against the baseline headers:
+//   mkdir -p /tmp/baseline && git archive 40ddf45 cpp | tar -x -C /tmp/baseline
+//   g++ -std=c++17 -O2 -mrdrnd -mbmi -mavx2 -fpermissive -w -I/tmp/baseline/cpp cpp/tools/score_vectors_gen.cc -o score_vectors_gen
+//   ./score_vectors_gen [numberOfSeeds] [vectorsPerSeed] > cpp/score_vectors.txt
+// Inputs are derived from a counter with KangarooTwelve, a run with the same arguments gives the same file.
+#include <iostream>
+#include <immintrin.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "keyUtils.hpp"
+#include "score.hpp"
+
+typedef ScoreFunction<1> ScoreFunctionType;
+
+static m256i deriveInput(unsigned int seedIdx, unsigned int vectorIdx, unsigned int field)
+{
+    unsigned int counter[3] = {seedIdx, vectorIdx, field};
+    m256i value;
+    KangarooTwelve((const unsigned char *)counter, sizeof(counter), value.m256i_u8, 32);
+    return value;
+}
+
+// Same digests as ScoreHyperIdentity/ScoreAddition::getBestNetworkDigest of the optimized scorer
+template <typename HyperIdentityScore>
+static m256i hyperIdentityNetworkDigest(const HyperIdentityScore &score)
+{
+    const auto &bestANN = score.bestANN;
+    unsigned char parts[3][32];
+    KangarooTwelve((const unsigned char *)bestANN.neurons, (unsigned int)(bestANN.population * sizeof(bestANN.neurons[0])), parts[0], 32);
+    KangarooTwelve(bestANN.neuronTypes, (unsigned int)(bestANN.population * sizeof(bestANN.neuronTypes[0])), parts[1], 32);
+    KangarooTwelve((const unsigned char *)bestANN.synapses, (unsigned int)(bestANN.population * HyperIdentityScore::numberOfNeighbors * sizeof(bestANN.synapses[0])), parts[2], 32);
+    m256i digest;
+    KangarooTwelve(parts[0], sizeof(parts), digest.m256i_u8, 32);
+    return digest;
+}
+
+template <typename AdditionScore>
+static m256i additionNetworkDigest(const AdditionScore &score)
+{
+    m256i digest;
+    KangarooTwelve(score.bestANN.synapsesPacked, sizeof(score.bestANN.synapsesPacked), digest.m256i_u8, 32);
+    return digest;
+}
+
+static void printHex(const m256i &value)
+{
+    for (int i = 0; i < 32; i++)
+    {
+        printf("%02x", value.m256i_u8[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const unsigned int numberOfSeeds = argc > 1 ? atoi(argv[1]) : 8;
+    const unsigned int vectorsPerSeed = argc > 2 ? atoi(argv[2]) : 4;
+
+    // Holds the compute buffers and two random2 pools inline, too large for the stack
+    ScoreFunctionType *scoreFunction = new ScoreFunctionType();
+    scoreFunction->initMemory();
+
+    printf("# Golden score vectors for the conformance runner (cpp/conformance.cc).\n");
+    printf("# One vector per line, hex fields: miningSeed publicKey nonce, then the expected score (decimal), getLastOutput()\n");
+    printf("# and the digest of the best network the search kept (getBestNetworkDigest()).\n");
+    printf("# Generated by cpp/tools/score_vectors_gen.cc from the baseline scorer of commit 40ddf45, not by the code under test.\n");
+    printf("# Nonce bit 0 selects the algo (even HyperIdentity, odd Addition). getLastOutput() is zero for Addition, and for\n");
+    printf("# HyperIdentity it is all ones once 256 output neurons are non-zero (it tests the sign of unsigned bytes), so the\n");
+    printf("# network digest is what tells the HyperIdentity runs apart.\n");
+    for (unsigned int seedIdx = 0; seedIdx < numberOfSeeds; seedIdx++)
+    {
+        const m256i miningSeed = deriveInput(seedIdx, 0, 0);
+        scoreFunction->initMiningData(miningSeed);
+        for (unsigned int vectorIdx = 0; vectorIdx < vectorsPerSeed; vectorIdx++)
+        {
+            const m256i publicKey = deriveInput(seedIdx, vectorIdx, 1);
+            m256i nonce = deriveInput(seedIdx, vectorIdx, 2);
+            // Alternate the algos so every seed covers both
+            nonce.m256i_u8[0] = (nonce.m256i_u8[0] & ~1) | (vectorIdx & 1);
+
+            const unsigned int score = (*scoreFunction)(0, publicKey, miningSeed, nonce);
+            const m256i lastOutput = scoreFunction->getLastOutput(0);
+            const m256i networkDigest = (nonce.m256i_u8[0] & 1) ? additionNetworkDigest(scoreFunction->_computeBuffer[0]._additionScore)
+                                                                : hyperIdentityNetworkDigest(scoreFunction->_computeBuffer[0]._hyperIdentityScore);
+
+            printHex(miningSeed);
+            printf(" ");
+            printHex(publicKey);
+            printf(" ");
+            printHex(nonce);
+            printf(" %u ", score);
+            printHex(lastOutput);
+            printf(" ");
+            printHex(networkDigest);
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -38,14 +38,36 @@ interface Addon {
     stopVerifyThread: () => void;
     initVerifyThread: (
         threads: number,
-        cb: ({ md5Hash, resultScore }: SolutionResult) => void
+        cb: (solutionResults: SolutionResult[]) => void
     ) => void;
+    prepareMiningSeed: (seed: string, cb: (isOk: boolean) => void) => void;
+    prepareStrayMiningSeed: (
+        seed: string,
+        cb: (isOk: boolean) => void
+    ) => void;
+    setRandom2PoolCacheDir: (dir: string) => void;
     pushSolutionToVerifyQueue: (
         seed: string,
         nonce: string,
         computorId: string,
-        md5Hash: string
+        md5Hash: string,
+        scoreThreshold: number
+    ) => boolean;
+    pushSolutionsBinary: (records: Buffer) => number;
+    verifySolutionsBatch: (
+        records: Buffer,
+        threads: number,
+        cb: (solutionResults: SolutionResult[] | Error) => void
     ) => void;
+    saveScoreCache: (epoch: number, dir: string) => boolean;
+    loadScoreCache: (epoch: number, dir: string) => boolean;
+    getScoreCacheStats: () => {
+        hits: number;
+        misses: number;
+        evictions: number;
+    };
+    getScoreIsa: () => string;
+    getProfile: () => { name: string; calls: number; cycles: number }[];
     checkScore: (score: number, threshold: number, algo: number) => boolean;
     pay: (
         ip: string,
@@ -69,6 +91,7 @@ interface Addon {
 let addon: Addon = bindings("q");
 
 const RawSolutionSize = 168; // 168 bytes
+const VerifySolutionRecordSize = 116; // seed[32] nonce[32] publicKey[32] md5Hash[16] scoreThreshold[4]
 
 namespace NodeManager {
     export let internalAddon = addon;
@@ -105,6 +128,14 @@ namespace NodeManager {
 
     export let initedVerifyThread: boolean = false;
 
+    let isPreparingStrayMiningSeed = false;
+
+    //seeds the node published, newest first. On a verify server they come from the main server, and only
+    //these seeds get random2 pools there
+    const MAX_PUBLISHED_MINING_SEEDS = 2;
+    let publishedMiningSeeds: string[] = [];
+    let isClusterVerifier = false;
+
     export async function saveData() {
         if (!isDiskLoaded) return;
         await saveToDisk();
@@ -159,11 +190,57 @@ namespace NodeManager {
                 `NodeManager.saveToDisk: failed to save difficulty or solutionsToSubmitQueue to disk ${error}`
             );
         }
+
+        saveScoreCache(Explorer?.ticksData?.tickInfo?.epoch);
+        logProfile();
+    }
+
+    // Only reports anything when the addon was built with USE_PROFILING
+    export function logProfile() {
+        for (let scope of addon.getProfile()) {
+            LOG(
+                "node",
+                `profile ${scope.name}: ${scope.calls} calls, ${(
+                    scope.cycles / 1e6
+                ).toFixed(1)} Mcycles, ${Math.round(
+                    scope.cycles / Math.max(scope.calls, 1)
+                )} cycles/call`
+            );
+        }
+    }
+
+    export function saveScoreCache(epoch: number) {
+        if (isNaN(epoch)) return;
+        let stats = addon.getScoreCacheStats();
+        if (!addon.saveScoreCache(epoch, DATA_PATH)) {
+            LOG(
+                "error",
+                `NodeManager.saveScoreCache: failed to save score cache of epoch ${epoch}`
+            );
+            return;
+        }
+        LOG(
+            "node",
+            `score cache of epoch ${epoch} saved (hits ${stats.hits}, misses ${stats.misses}, evictions ${stats.evictions})`
+        );
+    }
+
+    export function loadScoreCache(epoch: number) {
+        if (isNaN(epoch)) return;
+        if (addon.loadScoreCache(epoch, DATA_PATH)) {
+            LOG("node", `score cache of epoch ${epoch} loaded`);
+        } else {
+            LOG(
+                "sys",
+                `score cache of epoch ${epoch} not found, will create new one`
+            );
+        }
     }
 
-    export async function loadData() {
+    export async function loadData(epoch?: number) {
         await loadFromDisk();
         await loadFromDb();
+        loadScoreCache(Number(epoch));
 
         isDiskLoaded = true;
     }
@@ -284,6 +361,18 @@ namespace NodeManager {
         return deletedIps.includes(checkTickIp.ip);
     }
 
+    // Scores are only compared against difficulty.pool and difficulty.net here, so verification can stop
+    // once a solution reaches the higher of both, such scores come back flagged as isScoreLowerBound and are
+    // stored with that flag. Verify servers report scores to the main server,
+    // which may use other difficulties, so they always compute exact scores.
+    // Taken when a solution is pushed, every solution carries the threshold of that moment.
+    export function getEarlyExitScoreThreshold() {
+        let isEnabled =
+            process.env.VERIFY_EARLY_EXIT === "true" &&
+            process.env.MODE !== "verify";
+        return isEnabled ? Math.max(difficulty.pool, difficulty.net) : 0;
+    }
+
     export function setDifficulty(newDiff: { pool?: number; net?: number }) {
         difficulty = { ...difficulty, ...newDiff };
 
@@ -297,6 +386,7 @@ namespace NodeManager {
         return difficulty;
     }
 
+    //solutions already pushed to the native queue stay there, they are verified after the next initVerifyThread
     export function stopVerifyThread() {
         LOG("node", "stopping verify thread");
         addon.stopVerifyThread();
@@ -331,13 +421,120 @@ namespace NodeManager {
         });
     }
 
-    export async function pushSolutionToVerifyQueue(
+    export function pushSolutionToVerifyQueue(
         seed: string,
         nonce: string,
         computorId: string,
         md5Hash: string
-    ) {
-        addon.pushSolutionToVerifyQueue(seed, nonce, computorId, md5Hash);
+    ): boolean {
+        return addon.pushSolutionToVerifyQueue(
+            seed,
+            nonce,
+            computorId,
+            md5Hash,
+            getEarlyExitScoreThreshold()
+        );
+    }
+
+    export function prepareMiningSeed(seed: string) {
+        if (!seed || seed === "-1") return;
+        addon.prepareMiningSeed(seed, (isOk: boolean) => {
+            if (!isOk)
+                LOG(
+                    "error",
+                    "NodeManager.prepareMiningSeed: failed to build random2 pool for seed " +
+                        seed
+                );
+        });
+    }
+
+    function pushPublishedMiningSeed(seed: string) {
+        seed = seed.toLowerCase();
+        if (publishedMiningSeeds[0] === seed) return;
+        publishedMiningSeeds = [seed, ...publishedMiningSeeds].slice(
+            0,
+            MAX_PUBLISHED_MINING_SEEDS
+        );
+    }
+
+    export function getPublishedMiningSeeds() {
+        return publishedMiningSeeds;
+    }
+
+    export function isPublishedMiningSeed(seed: string) {
+        return publishedMiningSeeds.includes(seed.toLowerCase());
+    }
+
+    //verify server: the main server reports the seeds the node published with every batch, the newest one is live
+    export function setPublishedMiningSeeds(seeds: string[]) {
+        isClusterVerifier = true;
+        publishedMiningSeeds = seeds
+            .slice(0, MAX_PUBLISHED_MINING_SEEDS)
+            .map((seed) => seed.toLowerCase());
+        if (
+            publishedMiningSeeds[0] &&
+            publishedMiningSeeds[0] !== currentMiningSeed
+        ) {
+            currentMiningSeed = publishedMiningSeeds[0];
+            prepareMiningSeed(currentMiningSeed);
+        }
+    }
+
+    // pools of seeds other than the live one are built one at a time into a spare slot, so they never push the
+    // live pools out. A request while another one is building is dropped, the solution asks again when it comes
+    // back unscored. Returns false when the seed is not going to be built, a verify server only builds seeds the
+    // node published
+    export function prepareStrayMiningSeed(seed: string) {
+        if (!seed) return false;
+        if (isClusterVerifier && !isPublishedMiningSeed(seed)) return false;
+        if (isPreparingStrayMiningSeed) return true;
+        if (seed.toLowerCase() === currentMiningSeed.toLowerCase()) {
+            prepareMiningSeed(seed);
+            return true;
+        }
+        isPreparingStrayMiningSeed = true;
+        addon.prepareStrayMiningSeed(seed, (isOk: boolean) => {
+            isPreparingStrayMiningSeed = false;
+            if (!isOk)
+                LOG(
+                    "error",
+                    "NodeManager.prepareStrayMiningSeed: failed to build random2 pool for seed " +
+                        seed
+                );
+        });
+        return true;
+    }
+
+    function packVerifySolutionRecords(
+        solutions: [md5Hash: string, solution: Solution][]
+    ): Buffer {
+        let helper = new QubicHelper();
+        let scoreThreshold = getEarlyExitScoreThreshold();
+        let records = Buffer.alloc(
+            solutions.length * VerifySolutionRecordSize
+        );
+        solutions.forEach(([md5Hash, solution], i) => {
+            let offset = i * VerifySolutionRecordSize;
+            let isHex =
+                records.write(solution.seed, offset, 32, "hex") === 32 &&
+                records.write(solution.nonce, offset + 32, 32, "hex") === 32;
+            //malformed seed or nonce, a zero seed is always scored as invalid
+            if (!isHex) records.fill(0, offset, offset + 64);
+            records.set(
+                helper.getIdentityBytes(solution.computorId),
+                offset + 64
+            );
+            records.write(md5Hash, offset + 96, 16, "hex");
+            records.writeUInt32LE(scoreThreshold, offset + 112);
+        });
+        return records;
+    }
+
+    // push solutions to the native verify queue in one call, returns how many were accepted (in order)
+    export function pushSolutionsToVerifyQueue(
+        solutions: [md5Hash: string, solution: Solution][]
+    ): number {
+        return addon.pushSolutionsBinary(packVerifySolutionRecords(solutions));
     }
 
     export function initLogger() {
@@ -371,7 +568,10 @@ namespace NodeManager {
             //     }
             // }
 
-            await syncMiningSeed();
+            if (!currentMiningSeed) {
+                await syncMiningSeed();
+                prepareMiningSeed(currentMiningSeed);
+            }
             watchMiningSeed();
         } catch (e: any) {
             LOG("error", "NodeManager.initToNodeSocket: " + e.message);
@@ -424,11 +624,25 @@ namespace NodeManager {
         },
         fromCluster: boolean = false
     ) {
-        let { md5Hash, resultScore, algo } = solutionResult;
+        let {
+            md5Hash,
+            resultScore,
+            algo,
+            isScoreLowerBound,
+            isSeedUnprepared,
+        } = solutionResult;
         if (!md5Hash) return;
         if (md5Hash.length > 32) {
             md5Hash = md5Hash.slice(0, 32);
         }
+        if (isSeedUnprepared) {
+            //not scored, verify it again once the pool of its seed is built
+            let solution = SolutionManager.requeueVerifying(md5Hash);
+            //a verify server drops it instead, the main server takes it back after its cluster timeout
+            if (solution && !prepareStrayMiningSeed(solution.seed))
+                SolutionManager.remove(md5Hash);
+            return;
+        }
         let isShare = addon.checkScore(resultScore, difficulty.pool, algo);
         let isSolution = addon.checkScore(resultScore, difficulty.net, algo);
 
@@ -463,19 +677,38 @@ namespace NodeManager {
                 isSolution,
                 resultScore,
                 algo,
+                isScoreLowerBound: !!isScoreLowerBound,
             });
         }
     }
 
+    export function handleOnVerifiedSolutions(
+        solutionResults: SolutionResult[]
+    ) {
+        for (let solutionResult of solutionResults) {
+            handleOnVerifiedSolution(solutionResult);
+        }
+    }
+
     export function initVerifyThread(threads: number) {
         gthreads = threads;
-        LOG("node", "init verify thread with " + threads + " threads");
-        addon.initVerifyThread(threads, handleOnVerifiedSolution);
+        if (process.env.RANDOM2_POOL_DISK_CACHE === "true") {
+            addon.setRandom2PoolCacheDir(DATA_PATH);
+        }
+        LOG(
+            "node",
+            "init verify thread with " +
+                threads +
+                " threads, score kernels use " +
+                addon.getScoreIsa()
+        );
+        addon.initVerifyThread(threads, handleOnVerifiedSolutions);
         setTimeout(() => {
             initedVerifyThread = true;
         }, ONE_SECOND * 5);
     }
 
+    //the new threads pick up the solutions the stopped ones left in the native queue
     export function restartVerifyThread() {
         stopVerifyThread();
         initedVerifyThread = false;
@@ -524,6 +757,10 @@ namespace NodeManager {
         currentSecretSeed = secretSeed;
         watchAndSubmitSolution();
         initLogger();
+        //register the live seed before the verify threads start, queued solutions of it then wait for its pool
+        //instead of coming back unscored
+        await syncMiningSeed();
+        prepareMiningSeed(currentMiningSeed);
         initVerifyThread(
             Number(process.env.MAX_VERIFICATION_THREADS) || os.cpus().length
         );
@@ -705,6 +942,7 @@ namespace NodeManager {
                                 );
                             }
                             currentMiningSeed = newSeed;
+                            pushPublishedMiningSeed(newSeed);
                             canBreak = true;
                             lastSuccessSyncSeed.fake = Date.now();
                             lastSuccessSyncSeed.real = Date.now();
@@ -735,6 +973,7 @@ namespace NodeManager {
                 let oldSeed = currentMiningSeed;
                 await syncMiningSeed();
                 if (oldSeed !== currentMiningSeed) {
+                    prepareMiningSeed(currentMiningSeed);
                     SocketManager.broadcast(
                         QatumEvents.getNewSeedPacket(currentMiningSeed)
                     );
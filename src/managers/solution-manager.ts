@@ -296,33 +296,17 @@ namespace SolutionManager {
         solutionQueue.delete(md5Hash);
     }
 
-    export function getLength() {
-        return solutionQueue.size;
+    //a solution that came back unscored goes to the end of the queue to be verified again
+    export function requeueVerifying(md5Hash: string) {
+        let solution = solutionVerifyingQueue.get(md5Hash);
+        if (!solution) return null;
+        solutionVerifyingQueue.delete(md5Hash);
+        solutionQueue.set(md5Hash, solution);
+        return solution;
     }
 
-    export function popSolution(fromCluster: boolean = false) {
-        try {
-            let [md5Hash, solution] = solutionQueue.entries().next().value as [
-                string,
-                Solution,
-            ];
-            //this request pop solution from cluster, we don't need to push it to the queue on this server
-            if (!fromCluster) {
-                solutionVerifyingQueue.set(md5Hash, solution);
-                NodeManager.pushSolutionToVerifyQueue(
-                    solution.seed,
-                    solution.nonce,
-                    solution.computorId,
-                    md5Hash
-                );
-            } else {
-                solutionClusterVerifyingQueue.set(md5Hash, solution);
-            }
-            solutionQueue.delete(md5Hash);
-            return solution;
-        } catch (e: any) {
-            return null;
-        }
+    export function getLength() {
+        return solutionQueue.size;
     }
 
     export function addNSolutionToVerifying(
@@ -330,11 +314,31 @@ namespace SolutionManager {
         fromCluster: boolean = false
     ) {
         let returnSolutions: Solution[] = [];
-        let i = 0;
-        while (i < n && !isEmpty() && isEnable) {
-            let solution = popSolution(fromCluster);
-            if (solution) returnSolutions.push(solution);
-            i++;
+        if (!fromCluster) {
+            if (!isEnable) return returnSolutions;
+            let candidates: [string, Solution][] = [];
+            for (let entry of solutionQueue) {
+                if (candidates.length >= n) break;
+                candidates.push(entry);
+            }
+            if (candidates.length === 0) return returnSolutions;
+            //native queue may be full, the rest stays in the queue for the next round
+            let accepted =
+                NodeManager.pushSolutionsToVerifyQueue(candidates);
+            for (let [md5Hash, solution] of candidates.slice(0, accepted)) {
+                solutionVerifyingQueue.set(md5Hash, solution);
+                solutionQueue.delete(md5Hash);
+                returnSolutions.push(solution);
+            }
+            return returnSolutions;
+        }
+        //verify servers only build pools of seeds the node published, solutions of other seeds stay here
+        for (let [md5Hash, solution] of solutionQueue) {
+            if (returnSolutions.length >= n || !isEnable) break;
+            if (!NodeManager.isPublishedMiningSeed(solution.seed)) continue;
+            solutionClusterVerifyingQueue.set(md5Hash, solution);
+            solutionQueue.delete(md5Hash);
+            returnSolutions.push(solution);
         }
 
         return returnSolutions;
@@ -358,11 +362,13 @@ namespace SolutionManager {
             isSolution,
             resultScore,
             algo,
+            isScoreLowerBound,
         }: {
             isShare: boolean;
             isSolution: boolean;
             resultScore: number;
             algo: number;
+            isScoreLowerBound: boolean;
         }
     ) {
         let solution =
@@ -375,6 +381,7 @@ namespace SolutionManager {
             isWritten: false,
             resultScore,
             algo,
+            isScoreLowerBound,
         });
         solutionVerifyingQueue.delete(md5Hash);
         solutionClusterVerifyingQueue.delete(md5Hash);
@@ -12,6 +12,8 @@ namespace Platform {
         if (!isNaN(Explorer?.ticksData?.tickInfo?.epoch)) {
             await saveData();
         }
+        //solutions left in the native queue die with the process, saveData above
+        //stores them back as pending since they are still verifying on the JS side
         NodeManager.stopVerifyThread();
         process.exit(code);
     }
@@ -29,7 +31,7 @@ namespace Platform {
     export async function loadData(epoch?: number) {
         await Explorer.loadData();
         let candicateEpoch = epoch || Explorer?.ticksData?.tickInfo?.epoch;
-        await NodeManager.loadData();
+        await NodeManager.loadData(candicateEpoch);
         await ComputorIdManager.loadData(candicateEpoch);
         await WorkerManager.loadData(candicateEpoch);
         await SolutionManager.loadData(candicateEpoch);
@@ -54,11 +54,16 @@ export interface SolutionResult {
     md5Hash: string;
     resultScore: number;
     algo: number;
+    //verification stopped at the early exit threshold, resultScore is only a lower bound
+    isScoreLowerBound?: boolean;
+    //the random2 pool of its seed was not ready, the solution was not scored and needs to be verified again
+    isSeedUnprepared?: boolean;
 }
 
 export type SolutionNetState = Solution & {
     algo: number;
     resultScore: number;
+    isScoreLowerBound?: boolean;
     isSolution: boolean;
     isWritten: boolean;
     isShare: boolean;
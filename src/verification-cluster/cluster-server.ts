@@ -49,6 +49,7 @@ namespace VerificationClusterServer {
                         JSON.stringify({
                             type: "get",
                             solutions,
+                            seeds: NodeManager.getPublishedMiningSeeds(),
                         }) + QatumEvents.DELIMITER
                     );
                 } else if (jsonObj.type === "set") {
@@ -138,9 +139,12 @@ namespace VerificationClusterServer {
             let jsonObj = JSON.parse(data) as {
                 type: "get";
                 solutions: Solution[];
+                seeds?: string[];
             };
 
             if (jsonObj.type === "get") {
+                //only the seeds the node published get random2 pools here, whatever seeds the solutions carry
+                NodeManager.setPublishedMiningSeeds(jsonObj.seeds || []);
                 for (let solution of jsonObj.solutions) {
                     LOG(
                         "cluster",